@@ -1,4 +1,4 @@
-QT += core gui
+QT += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -9,23 +9,80 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+	autosave.cpp \
 	chapter.cpp \
 	entry.cpp \
+	entrymodel.cpp \
 	main.cpp \
 	omm.cpp
 
 HEADERS += \
+	autosave.hpp \
+	binaryformat.hpp \
 	chapter.hpp \
 	chapters.hpp \
+	components.hpp \
 	counts.hpp \
 	entries.hpp \
 	entry.hpp \
+	entrymodel.hpp \
+	facets.hpp \
+	field.hpp \
+	journal.hpp \
+	jsonreader.hpp \
+	jsonwriter.hpp \
 	omm.hpp \
-	save.hpp
+	parallel.hpp \
+	profiler.hpp \
+	progress.hpp \
+	save.hpp \
+	searchindex.hpp \
+	stringarena.hpp
 
 FORMS += \
 	omm.ui
 
+# The profiling build (qmake CONFIG+=profile), which measures the hot paths and shows the counts over the window;
+# see profiler.hpp. It counts allocations as well, in the GUI and the command-line build alike.
+profile {
+	DEFINES += OMM_PROFILE OMM_COUNT_ALLOCATIONS
+
+	SOURCES += \
+		allocations.cpp \
+		profileoverlay.cpp
+	HEADERS += \
+		allocations.hpp \
+		profileoverlay.hpp
+}
+
+# The headless command-line build of the same core (qmake CONFIG+=cli), for batch maintenance without the GUI.
+cli {
+	TARGET = omm-cli
+	QT -= gui widgets
+	CONFIG += console
+	CONFIG -= app_bundle
+
+	SOURCES -= \
+		autosave.cpp \
+		entrymodel.cpp \
+		main.cpp \
+		omm.cpp \
+		profileoverlay.cpp
+	SOURCES += \
+		cli.cpp
+
+	HEADERS -= \
+		autosave.hpp \
+		entrymodel.hpp \
+		omm.hpp \
+		profileoverlay.hpp
+	HEADERS += \
+		generator.hpp
+
+	FORMS -= \
+		omm.ui
+}
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
@@ -0,0 +1,245 @@
+#include "allocations.hpp"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(OMM_COUNT_MALLOC) && defined(__GLIBC__)
+#include <cerrno>
+#include <malloc.h>
+#elif defined(_WIN32)
+#include <malloc.h>
+#endif
+
+// The allocations made so far by this thread; each thread counts its own, so that counting takes no shared writes.
+// It is constant-initialized, so that it can be used inside malloc before anything else is set up.
+static thread_local omm::Allocations allocations{0, 0};
+
+// Count an allocation of the given size.
+static void count_allocation(std::size_t const size) noexcept {
+	++allocations.count;
+	allocations.bytes += size;
+}
+
+#if defined(OMM_COUNT_MALLOC) && defined(__GLIBC__)
+// In the benchmarks (OMM_COUNT_MALLOC) with glibc, malloc itself is replaced for the whole process, so that the storage
+// of QString, QByteArray, QList, and the other Qt containers, which is allocated with malloc, is counted along with
+// everything allocated with operator new, which allocates with malloc too.
+// This relies on glibc: a program may define malloc and the functions that go with it, which then take the place of
+// those of glibc everywhere in the process (including inside Qt), and glibc exports its own implementations as
+// __libc_malloc and so on, which each replacement forwards to. Every function that allocates is replaced, so that no
+// allocation reaches glibc uncounted and no block allocated by one implementation is freed by the other.
+extern "C" {
+	void *__libc_malloc(std::size_t size) noexcept;
+	void *__libc_calloc(std::size_t count, std::size_t size) noexcept;
+	void *__libc_realloc(void *p, std::size_t size) noexcept;
+	void *__libc_memalign(std::size_t alignment, std::size_t size) noexcept;
+	void *__libc_valloc(std::size_t size) noexcept;
+	void *__libc_pvalloc(std::size_t size) noexcept;
+	void __libc_free(void *p) noexcept;
+
+	void *malloc(std::size_t const size) noexcept {
+		count_allocation(size);
+		return __libc_malloc(size);
+	}
+
+	void *calloc(std::size_t const count, std::size_t const size) noexcept {
+		count_allocation(count * size);
+		return __libc_calloc(count, size);
+	}
+
+	// Growing or shrinking a block counts as an allocation, since it may move the block; freeing it does not.
+	void *realloc(void *const p, std::size_t const size) noexcept {
+		if(!p || size) {
+			count_allocation(size);
+		}
+		return __libc_realloc(p, size);
+	}
+
+	// Counted as realloc; glibc exports no implementation of its own to forward to.
+	void *reallocarray(void *const p, std::size_t const count, std::size_t const size) noexcept {
+		if(size && count > static_cast<std::size_t>(-1) / size) {
+			errno = ENOMEM;
+			return nullptr;
+		}
+		return realloc(p, count * size);
+	}
+
+	void *memalign(std::size_t const alignment, std::size_t const size) noexcept {
+		count_allocation(size);
+		return __libc_memalign(alignment, size);
+	}
+
+	// The other aligned forms are counted as memalign, after the checks that glibc makes of their arguments.
+	void *aligned_alloc(std::size_t const alignment, std::size_t const size) noexcept {
+		if(!alignment || (alignment & (alignment - 1))) {
+			errno = EINVAL;
+			return nullptr;
+		}
+		return memalign(alignment, size);
+	}
+
+	int posix_memalign(void **const p, std::size_t const alignment, std::size_t const size) noexcept {
+		if(alignment % sizeof(void *) || (alignment & (alignment - 1)) || !alignment) {
+			return EINVAL;
+		}
+		void *const allocated = memalign(alignment, size);
+		if(!allocated) {
+			return ENOMEM;
+		}
+		*p = allocated;
+		return 0;
+	}
+
+	void *valloc(std::size_t const size) noexcept {
+		count_allocation(size);
+		return __libc_valloc(size);
+	}
+
+	void *pvalloc(std::size_t const size) noexcept {
+		count_allocation(size);
+		return __libc_pvalloc(size);
+	}
+
+	void free(void *const p) noexcept {
+		__libc_free(p);
+	}
+}
+#else
+// Elsewhere, including the profiling builds, only the allocations made with the global operator new are counted, by
+// the replacements below, which leaves out the storage of the Qt containers. Every form of it is replaced, so that
+// each allocation is counted the same way; the aligned forms allocate with their own functions, since blocks from
+// std::malloc are only aligned for the fundamental types.
+
+// Allocate a block of the given size and alignment, or return nullptr if there is no memory for it.
+static void *allocate_aligned(std::size_t const size, std::size_t const alignment) noexcept {
+#if defined(_WIN32)
+	return _aligned_malloc(size ? size : 1, alignment);
+#else
+	void *p = nullptr;
+	if(posix_memalign(&p, alignment < sizeof(void *) ? sizeof(void *) : alignment, size ? size : 1) != 0) {
+		return nullptr;
+	}
+	return p;
+#endif
+}
+
+// Free a block allocated by allocate_aligned().
+static void free_aligned(void *const p) noexcept {
+#if defined(_WIN32)
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+void *operator new(std::size_t const size) {
+	count_allocation(size);
+	if(void *const p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t const size) {
+	return operator new(size);
+}
+
+void *operator new(std::size_t const size, std::nothrow_t const &) noexcept {
+	try {
+		return operator new(size);
+	}
+	catch(std::bad_alloc const &) {
+		return nullptr;
+	}
+}
+
+void *operator new[](std::size_t const size, std::nothrow_t const &) noexcept {
+	try {
+		return operator new(size);
+	}
+	catch(std::bad_alloc const &) {
+		return nullptr;
+	}
+}
+
+void *operator new(std::size_t const size, std::align_val_t const alignment) {
+	count_allocation(size);
+	if(void *const p = allocate_aligned(size, static_cast<std::size_t>(alignment))) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t const size, std::align_val_t const alignment) {
+	return operator new(size, alignment);
+}
+
+void *operator new(std::size_t const size, std::align_val_t const alignment, std::nothrow_t const &) noexcept {
+	count_allocation(size);
+	return allocate_aligned(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t const size, std::align_val_t const alignment, std::nothrow_t const &) noexcept {
+	count_allocation(size);
+	return allocate_aligned(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *const p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *const p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *const p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *const p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *const p, std::nothrow_t const &) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *const p, std::nothrow_t const &) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *const p, std::align_val_t) noexcept {
+	free_aligned(p);
+}
+
+void operator delete[](void *const p, std::align_val_t) noexcept {
+	free_aligned(p);
+}
+
+void operator delete(void *const p, std::size_t, std::align_val_t) noexcept {
+	free_aligned(p);
+}
+
+void operator delete[](void *const p, std::size_t, std::align_val_t) noexcept {
+	free_aligned(p);
+}
+
+void operator delete(void *const p, std::align_val_t, std::nothrow_t const &) noexcept {
+	free_aligned(p);
+}
+
+void operator delete[](void *const p, std::align_val_t, std::nothrow_t const &) noexcept {
+	free_aligned(p);
+}
+#endif
+
+namespace omm {
+	Allocations get_allocations() noexcept {
+		return allocations;
+	}
+
+	void add_allocations(Allocations const added) noexcept {
+		allocations.count += added.count;
+		allocations.bytes += added.bytes;
+	}
+} // namespace omm
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The number and total size of the allocations made.
+	struct Allocations {
+		std::size_t count;
+		std::size_t bytes;
+	};
+
+	// Returns the allocations made so far by the calling thread, including those handed to it with add_allocations().
+	// They are only counted in the builds that link allocations.cpp (the profiling builds and the benchmarks):
+	// in the benchmarks with glibc, every allocation made with malloc, including the storage of the Qt containers,
+	// and elsewhere only those made with operator new, which leaves out the Qt containers.
+	Allocations get_allocations() noexcept;
+
+	// Count the given allocations as made by the calling thread, e.g. those of the threads it waited for.
+	void add_allocations(Allocations added) noexcept;
+} // namespace omm
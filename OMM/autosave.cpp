@@ -0,0 +1,35 @@
+#include "autosave.hpp"
+
+namespace omm {
+	AutoSave::AutoSave(int const idleInterval, int const _maxEdits, QObject *parent):
+			QObject(parent), idleTimer(), edits(0), maxEdits(_maxEdits) {
+		idleTimer.setSingleShot(true);
+		idleTimer.setInterval(idleInterval);
+		connect(&idleTimer, &QTimer::timeout, this, &AutoSave::flush);
+	}
+
+	void AutoSave::note_edit() {
+		if(++edits >= maxEdits) {
+			flush();
+
+			return;
+		}
+
+		// Each edit pushes the save back, so a burst of edits is saved once it is over.
+		idleTimer.start();
+	}
+
+	void AutoSave::note_saved() {
+		idleTimer.stop();
+		edits = 0;
+	}
+
+	void AutoSave::flush() {
+		if(edits == 0) {
+			return;
+		}
+
+		note_saved();
+		emit save_due();
+	}
+} // namespace omm
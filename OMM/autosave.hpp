@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The class that decides when to save automatically, coalescing bursts of edits into one save.
+	// A save is due once no edit was made for a while, or once enough edits have piled up, whichever comes first.
+	class AutoSave: public QObject {
+		Q_OBJECT
+
+		private:
+		// Fires once no edit was made for the idle interval.
+		QTimer idleTimer;
+		// The number of edits made since the last save.
+		int edits;
+		// The number of edits after which a save is due even if edits keep coming.
+		int maxEdits;
+
+		public:
+		// Constructor that takes how long to wait after the last edit and how many edits to allow before saving.
+		explicit AutoSave(int idleInterval = 2000, int _maxEdits = 256, QObject *parent = nullptr);
+
+		// Note that an edit was made.
+		void note_edit();
+		// Note that the save was saved some other way, so no save is due.
+		void note_saved();
+		// Make the pending save due now, if any (e.g. on exit).
+		void flush();
+
+		signals:
+		// Emitted when the save should be saved.
+		void save_due();
+	};
+} // namespace omm
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QString>
+#include <QtEndian>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "counts.hpp"
+#include "entry.hpp"
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The layout of the binary save format; all numbers are little-endian, and every section starts 8-byte aligned.
+	// Header: magic "OMMB", version, string count, entry count, the offsets of the sections below,
+	// the string index of the ID, the total count, the ID to give the next new entry, and the generation of the save.
+	// Strings: an index of (offset, length) pairs into a block of UTF-16 code units; every string is stored once.
+	// Entries: one fixed-width record per entry (see EntryRecord).
+	// Custom fields: (key string, value string) pairs referred to by the entry records.
+	// Chapters: packed lists of chapters referred to by the entry records, each as its single-level ranges of chapters
+	// as their two ends, followed by its deeper chapters as their depth, their left end, and the last component of
+	// their right end (the other components of both ends are the same).
+	// Counts: the counts by type, language, and progress, each as a length followed by (key string, count) pairs.
+	namespace binary {
+		// The magic number at the start of every binary save.
+		inline constexpr char magic[4]{'O', 'M', 'M', 'B'};
+		// The version of the binary save format.
+		inline constexpr quint32 version = 1;
+
+		// The header at the start of every binary save.
+		struct Header {
+			char magic[4];
+			quint32 version;
+			quint32 stringCount;
+			quint32 entryCount;
+			quint64 stringIndexOffset;
+			quint64 stringDataOffset;
+			quint64 entryOffset;
+			quint64 customOffset;
+			quint64 chapterOffset;
+			quint64 countsOffset;
+			quint64 fileSize;
+			quint32 id;
+			quint32 reserved;
+			quint64 countTotal;
+			quint64 nextEntryId;
+			quint64 generation;
+		};
+
+		// The fixed-width record of an entry; every member is a 32-bit number.
+		struct EntryRecord {
+			// The string indices of the standard fields.
+			quint32 fields[standardFieldCount];
+			// The position and number of the custom fields in the custom fields section.
+			quint32 customIndex, customCount;
+			// The position in the chapters section, the number of single-level ranges, and the number of deeper chapters
+			// of the liked chapters.
+			quint32 likedIndex, likedSpanCount, likedCount;
+			// The same for the loved chapters.
+			quint32 lovedIndex, lovedSpanCount, lovedCount;
+			// The low and high halves of the ID of the entry.
+			quint32 idLow, idHigh;
+		};
+
+		// The number of 32-bit numbers in an entry record.
+		inline constexpr std::size_t entryRecordSize = sizeof(EntryRecord) / sizeof(quint32);
+
+		// Round the given offset up to a multiple of 8.
+		inline quint64 align(quint64 const offset) noexcept {
+			return (offset + 7) & ~quint64(7);
+		}
+	} // namespace binary
+
+	// The class that memory-maps a binary save and decodes its parts on demand.
+	class BinaryImage {
+		private:
+		// The mapped file, kept open for as long as the mapping is used.
+		QFile file;
+		// The start of the mapping.
+		uchar const *data;
+		// The header of the binary save.
+		binary::Header header;
+
+		// Read the 32-bit number at the given position of the section at the given offset.
+		quint32 read_u32(quint64 const offset, quint64 const index) const {
+			return qFromLittleEndian<quint32>(data + offset + index * sizeof(quint32));
+		}
+
+		// Returns true if the given number of 32-bit numbers from the given position fit in the given section.
+		bool fits(quint64 const sectionOffset, quint64 const sectionEnd, quint64 const index, quint64 const count) const {
+			return sectionOffset + (index + count) * sizeof(quint32) <= sectionEnd;
+		}
+
+		// Decode the given numbers of packed single-level ranges and deeper chapters starting at the given position
+		// into the given list.
+		void decode_chapters(quint32 const index, quint32 const spanCount, quint32 const count, Chapters &chapters) const {
+			quint64 at = index;
+			if(!fits(header.chapterOffset, header.countsOffset, at, quint64(spanCount) * 2)) {
+				return;
+			}
+
+			SpanVector spans;
+			spans.reserve(spanCount);
+			for(quint32 a = 0; a < spanCount; ++a, at += 2) {
+				auto const l = static_cast<qint32>(read_u32(header.chapterOffset, at)),
+						   r = static_cast<qint32>(read_u32(header.chapterOffset, at + 1));
+				if(l <= r) {
+					spans.push_back(ChapterSpan{l, r});
+				}
+			}
+
+			ChapterVector decoded;
+			decoded.reserve(count);
+			for(quint32 a = 0; a < count; ++a) {
+				if(!fits(header.chapterOffset, header.countsOffset, at, 1)) {
+					break;
+				}
+				quint32 const depth = read_u32(header.chapterOffset, at++);
+				if(depth < 2 || !fits(header.chapterOffset, header.countsOffset, at, depth + 1)) {
+					break;
+				}
+
+				Components l, r;
+				l.reserve(depth);
+				for(quint32 b = 0; b < depth; ++b) {
+					l.push_back(static_cast<qint32>(read_u32(header.chapterOffset, at++)));
+				}
+				r = l;
+				r.back() = static_cast<qint32>(read_u32(header.chapterOffset, at++));
+				decoded.emplace_back(std::move(l), std::move(r));
+			}
+			chapters.assign(std::move(spans), std::move(decoded));
+		}
+
+		public:
+		// Constructor that maps nothing; use open().
+		BinaryImage(): file(), data(nullptr), header() {}
+
+		~BinaryImage() {
+			if(data) {
+				file.unmap(const_cast<uchar *>(data));
+			}
+		}
+
+		BinaryImage(BinaryImage const &) = delete;
+		BinaryImage &operator=(BinaryImage const &) = delete;
+
+		// Map the binary save at the given path; returns nullptr if it cannot be opened or is not a valid binary save.
+		static std::shared_ptr<BinaryImage const> open(QString const &path) {
+			auto image = std::make_shared<BinaryImage>();
+			image->file.setFileName(path);
+			if(!image->file.open(QIODevice::ReadOnly)) {
+				return nullptr;
+			}
+
+			qint64 const size = image->file.size();
+			if(size < static_cast<qint64>(sizeof(binary::Header))) {
+				return nullptr;
+			}
+			image->data = image->file.map(0, size);
+			if(!image->data) {
+				return nullptr;
+			}
+
+			// Read and check the header.
+			auto &h = image->header;
+			uchar const *const d = image->data;
+			std::memcpy(h.magic, d, sizeof(h.magic));
+			h.version = qFromLittleEndian<quint32>(d + offsetof(binary::Header, version));
+			h.stringCount = qFromLittleEndian<quint32>(d + offsetof(binary::Header, stringCount));
+			h.entryCount = qFromLittleEndian<quint32>(d + offsetof(binary::Header, entryCount));
+			h.stringIndexOffset = qFromLittleEndian<quint64>(d + offsetof(binary::Header, stringIndexOffset));
+			h.stringDataOffset = qFromLittleEndian<quint64>(d + offsetof(binary::Header, stringDataOffset));
+			h.entryOffset = qFromLittleEndian<quint64>(d + offsetof(binary::Header, entryOffset));
+			h.customOffset = qFromLittleEndian<quint64>(d + offsetof(binary::Header, customOffset));
+			h.chapterOffset = qFromLittleEndian<quint64>(d + offsetof(binary::Header, chapterOffset));
+			h.countsOffset = qFromLittleEndian<quint64>(d + offsetof(binary::Header, countsOffset));
+			h.fileSize = qFromLittleEndian<quint64>(d + offsetof(binary::Header, fileSize));
+			h.id = qFromLittleEndian<quint32>(d + offsetof(binary::Header, id));
+			h.countTotal = qFromLittleEndian<quint64>(d + offsetof(binary::Header, countTotal));
+			h.nextEntryId = qFromLittleEndian<quint64>(d + offsetof(binary::Header, nextEntryId));
+			h.generation = qFromLittleEndian<quint64>(d + offsetof(binary::Header, generation));
+			if(std::memcmp(h.magic, binary::magic, sizeof(h.magic)) != 0 || h.version != binary::version ||
+					h.fileSize != static_cast<quint64>(size) || h.stringIndexOffset < sizeof(binary::Header) ||
+					h.stringDataOffset < h.stringIndexOffset + quint64(h.stringCount) * 2 * sizeof(quint32) ||
+					h.entryOffset < h.stringDataOffset ||
+					h.customOffset < h.entryOffset + quint64(h.entryCount) * sizeof(binary::EntryRecord) ||
+					h.chapterOffset < h.customOffset || h.countsOffset < h.chapterOffset || h.fileSize < h.countsOffset) {
+				return nullptr;
+			}
+
+			return image;
+		}
+
+		// Returns the number of entries in the binary save.
+		quint32 entry_count() const noexcept {
+			return header.entryCount;
+		}
+
+		// Returns the total count stored in the binary save.
+		quint64 count_total() const noexcept {
+			return header.countTotal;
+		}
+
+		// Returns the ID to give the next new entry stored in the binary save.
+		EntryId next_entry_id() const noexcept {
+			return header.nextEntryId;
+		}
+
+		// Returns the number of full saves of the save up to this one, which ties a journal to it (see Save).
+		qint64 generation() const noexcept {
+			return static_cast<qint64>(header.generation);
+		}
+
+		// Returns the ID of the entry with the given index, which is read without decoding the entry.
+		EntryId entry_id(quint32 const index) const {
+			if(index >= header.entryCount) {
+				return 0;
+			}
+
+			quint64 const base = quint64(index) * binary::entryRecordSize;
+			return read_u32(header.entryOffset, base + standardFieldCount + 8) |
+				   EntryId(read_u32(header.entryOffset, base + standardFieldCount + 9)) << 32;
+		}
+
+		// Returns the string with the given index, or an empty string if there is no such string.
+		QString string(quint32 const index) const {
+			if(index >= header.stringCount) {
+				return QString();
+			}
+
+			quint64 const offset = read_u32(header.stringIndexOffset, quint64(index) * 2),
+						  length = read_u32(header.stringIndexOffset, quint64(index) * 2 + 1),
+						  begin = header.stringDataOffset + offset * sizeof(char16_t);
+			if(begin + length * sizeof(char16_t) > header.entryOffset) {
+				return QString();
+			}
+
+			auto const units = reinterpret_cast<char16_t const *>(data + begin);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+			return QString(reinterpret_cast<QChar const *>(units), static_cast<qsizetype>(length));
+#else
+			QString s(static_cast<qsizetype>(length), Qt::Uninitialized);
+			for(quint64 a = 0; a < length; ++a) {
+				s[static_cast<qsizetype>(a)] = QChar(qFromLittleEndian<quint16>(units + a));
+			}
+			return s;
+#endif
+		}
+
+		// Returns the ID stored in the binary save.
+		QString id() const {
+			return string(header.id);
+		}
+
+		// Decode the counts by type, language, and progress into the given groups of counts.
+		void decode_counts(Counts &byType, Counts &byLanguage, Counts &byProgress) const {
+			quint64 at = 0;
+			for(Counts *counts: {&byType, &byLanguage, &byProgress}) {
+				counts->clear();
+				if(!fits(header.countsOffset, header.fileSize, at, 1)) {
+					return;
+				}
+				quint32 const size = read_u32(header.countsOffset, at++);
+				for(quint32 a = 0; a < size && fits(header.countsOffset, header.fileSize, at, 2); ++a, at += 2) {
+					(*counts)[string(read_u32(header.countsOffset, at))] =
+							static_cast<qint32>(read_u32(header.countsOffset, at + 1));
+				}
+			}
+		}
+
+		// Decode the entry with the given index into the given entry, which should be empty; its ID is left as it is.
+		void decode_entry(quint32 const index, Entry &entry) const {
+			if(index >= header.entryCount) {
+				return;
+			}
+
+			quint64 const base = quint64(index) * binary::entryRecordSize;
+			auto const field = [&](std::size_t const member) {
+				return read_u32(header.entryOffset, base + member);
+			};
+			for(std::size_t a = 0; a < standardFieldCount; ++a) {
+				entry[static_cast<Field>(a)] = string(field(a));
+			}
+
+			// Custom fields.
+			quint32 const customIndex = field(standardFieldCount), customCount = field(standardFieldCount + 1);
+			if(fits(header.customOffset, header.chapterOffset, quint64(customIndex) * 2, quint64(customCount) * 2)) {
+				for(quint32 a = 0; a < customCount; ++a) {
+					quint64 const at = (quint64(customIndex) + a) * 2;
+					entry[FieldKeys::intern(string(read_u32(header.customOffset, at)))] =
+							string(read_u32(header.customOffset, at + 1));
+				}
+			}
+
+			// Liked and loved chapters.
+			decode_chapters(field(standardFieldCount + 2), field(standardFieldCount + 3), field(standardFieldCount + 4),
+					entry.get_likedChapters());
+			decode_chapters(field(standardFieldCount + 5), field(standardFieldCount + 6), field(standardFieldCount + 7),
+					entry.get_lovedChapters());
+		}
+	};
+
+	// The class that collects the parts of a binary save and writes them out.
+	class BinaryBuilder {
+		private:
+		// The index of each string added so far.
+		QHash<QString, quint32> stringIds;
+		// The (offset, length) pairs of the strings.
+		std::vector<quint32> stringIndex;
+		// The UTF-16 code units of the strings.
+		std::vector<quint16> stringData;
+		// The entry records.
+		std::vector<quint32> entryRecords;
+		// The (key string, value string) pairs of the custom fields.
+		std::vector<quint32> customFields;
+		// The packed chapters.
+		std::vector<quint32> chapterData;
+		// The counts by type, language, and progress.
+		std::vector<quint32> countsData;
+		// The number of entries added so far.
+		quint32 entryCount;
+
+		// Add the given chapters in packed form and record where they are in the given entry record.
+		void add_chapters(Chapters const &chapters, std::size_t const member) {
+			std::size_t const base = entryRecords.size() - binary::entryRecordSize + member;
+			entryRecords[base] = static_cast<quint32>(chapterData.size());
+			entryRecords[base + 1] = static_cast<quint32>(chapters.get_spans().size());
+			entryRecords[base + 2] = static_cast<quint32>(chapters.get_multilevel().size());
+			for(auto const &span: chapters.get_spans()) {
+				chapterData.push_back(static_cast<quint32>(span.l));
+				chapterData.push_back(static_cast<quint32>(span.r));
+			}
+			for(auto const &chapter: chapters.get_multilevel()) {
+				chapterData.push_back(static_cast<quint32>(chapter.get_l().size()));
+				for(int const component: chapter.get_l()) {
+					chapterData.push_back(static_cast<quint32>(component));
+				}
+				chapterData.push_back(static_cast<quint32>(chapter.get_r().back()));
+			}
+		}
+
+		// Write the given section padded to a multiple of 8 bytes.
+		template<typename T>
+		static bool write_section(QIODevice &device, std::vector<T> const &section) {
+			QByteArray bytes(static_cast<qsizetype>(binary::align(section.size() * sizeof(T))), '\0');
+			for(std::size_t a = 0; a < section.size(); ++a) {
+				qToLittleEndian<T>(section[a], bytes.data() + a * sizeof(T));
+			}
+			return device.write(bytes) == bytes.size();
+		}
+
+		public:
+		BinaryBuilder(): entryCount(0) {}
+
+		// Returns the index of the given string, adding it if needed.
+		quint32 add_string(QString const &string) {
+			auto si = stringIds.constFind(string);
+			if(si != stringIds.cend()) {
+				return si.value();
+			}
+
+			auto const id = static_cast<quint32>(stringIds.size());
+			stringIds.insert(string, id);
+			stringIndex.push_back(static_cast<quint32>(stringData.size()));
+			stringIndex.push_back(static_cast<quint32>(string.size()));
+			for(QChar const c: string) {
+				stringData.push_back(c.unicode());
+			}
+			return id;
+		}
+
+		// Add the given entry.
+		void add_entry(Entry const &entry) {
+			entryRecords.resize(entryRecords.size() + binary::entryRecordSize);
+			std::size_t const base = entryRecords.size() - binary::entryRecordSize;
+			for(std::size_t a = 0; a < standardFieldCount; ++a) {
+				entryRecords[base + a] = add_string(entry.at(static_cast<Field>(a)));
+			}
+
+			entryRecords[base + standardFieldCount] = static_cast<quint32>(customFields.size() / 2);
+			entryRecords[base + standardFieldCount + 1] = static_cast<quint32>(entry.get_customFields().size());
+			for(auto const &[key, value]: entry.get_customFields()) {
+				customFields.push_back(add_string(FieldKeys::name(key)));
+				customFields.push_back(add_string(value));
+			}
+
+			add_chapters(entry.get_likedChapters(), standardFieldCount + 2);
+			add_chapters(entry.get_lovedChapters(), standardFieldCount + 5);
+			entryRecords[base + standardFieldCount + 8] = static_cast<quint32>(entry.get_id());
+			entryRecords[base + standardFieldCount + 9] = static_cast<quint32>(entry.get_id() >> 32);
+			++entryCount;
+		}
+
+		// Add the given group of counts; must be called for the counts by type, language, and progress in order.
+		void add_counts(Counts const &counts) {
+			std::size_t const sizeAt = countsData.size();
+			countsData.push_back(0);
+			for(auto ci = counts.cbegin(); ci != counts.cend(); ++ci) {
+				countsData.push_back(add_string(ci->first));
+				countsData.push_back(static_cast<quint32>(ci->second));
+				++countsData[sizeAt];
+			}
+		}
+
+		// Write the binary save with the given ID, total count, ID to give the next new entry, and generation to the given
+		// device.
+		bool write(QIODevice &device, QString const &id, quint64 const countTotal, EntryId const nextEntryId,
+				qint64 const generation) {
+			quint32 const idString = add_string(id);
+
+			// Lay out the sections one after another.
+			binary::Header h{};
+			std::memcpy(h.magic, binary::magic, sizeof(h.magic));
+			h.version = binary::version;
+			h.stringCount = static_cast<quint32>(stringIds.size());
+			h.entryCount = entryCount;
+			h.stringIndexOffset = binary::align(sizeof(binary::Header));
+			h.stringDataOffset = h.stringIndexOffset + binary::align(stringIndex.size() * sizeof(quint32));
+			h.entryOffset = h.stringDataOffset + binary::align(stringData.size() * sizeof(quint16));
+			h.customOffset = h.entryOffset + binary::align(entryRecords.size() * sizeof(quint32));
+			h.chapterOffset = h.customOffset + binary::align(customFields.size() * sizeof(quint32));
+			h.countsOffset = h.chapterOffset + binary::align(chapterData.size() * sizeof(quint32));
+			h.fileSize = h.countsOffset + binary::align(countsData.size() * sizeof(quint32));
+			h.id = idString;
+			h.countTotal = countTotal;
+			h.nextEntryId = nextEntryId;
+			h.generation = static_cast<quint64>(generation);
+
+			// Write the header in little-endian form.
+			QByteArray header(static_cast<qsizetype>(binary::align(sizeof(binary::Header))), '\0');
+			char *const d = header.data();
+			std::memcpy(d, h.magic, sizeof(h.magic));
+			qToLittleEndian<quint32>(h.version, d + offsetof(binary::Header, version));
+			qToLittleEndian<quint32>(h.stringCount, d + offsetof(binary::Header, stringCount));
+			qToLittleEndian<quint32>(h.entryCount, d + offsetof(binary::Header, entryCount));
+			qToLittleEndian<quint64>(h.stringIndexOffset, d + offsetof(binary::Header, stringIndexOffset));
+			qToLittleEndian<quint64>(h.stringDataOffset, d + offsetof(binary::Header, stringDataOffset));
+			qToLittleEndian<quint64>(h.entryOffset, d + offsetof(binary::Header, entryOffset));
+			qToLittleEndian<quint64>(h.customOffset, d + offsetof(binary::Header, customOffset));
+			qToLittleEndian<quint64>(h.chapterOffset, d + offsetof(binary::Header, chapterOffset));
+			qToLittleEndian<quint64>(h.countsOffset, d + offsetof(binary::Header, countsOffset));
+			qToLittleEndian<quint64>(h.fileSize, d + offsetof(binary::Header, fileSize));
+			qToLittleEndian<quint32>(h.id, d + offsetof(binary::Header, id));
+			qToLittleEndian<quint64>(h.countTotal, d + offsetof(binary::Header, countTotal));
+			qToLittleEndian<quint64>(h.nextEntryId, d + offsetof(binary::Header, nextEntryId));
+			qToLittleEndian<quint64>(h.generation, d + offsetof(binary::Header, generation));
+
+			return device.write(header) == header.size() && write_section(device, stringIndex) &&
+				   write_section(device, stringData) && write_section(device, entryRecords) &&
+				   write_section(device, customFields) && write_section(device, chapterData) &&
+				   write_section(device, countsData);
+		}
+	};
+} // namespace omm
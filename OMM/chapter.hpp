@@ -1,61 +1,99 @@
 #pragma once
 
+#include <QChar>
 #include <QJsonArray>
 #include <QString>
-#include <cstdlib>
-#include <exception>
-#include <string>
+#include <QStringView>
+#include <algorithm>
+#include <limits>
 #include <utility>
-#include <vector>
+
+#include "components.hpp"
 
 // Exclusive namespace for the OMM.
 namespace omm {
-	using IntVector = std::vector<int>;
-
 	enum class ChapterState : int { Valid = 0, Reversed, MultiSection, DifferentDepth, ConversionFailure };
 
 	// The class that manages a chapter.
 	class Chapter {
 		private:
-		// The vector containing the components of the left end of the range of chapters or the single chapter.
-		IntVector l;
-		// The vector containing the components of the right end of the range of chapters or the single chapter (equal to l).
-		IntVector r;
+		// The components of the left end of the range of chapters or the single chapter.
+		Components l;
+		// The components of the right end of the range of chapters or the single chapter (equal to l).
+		Components r;
+
+		// Parses the number at the given position the way std::stoi does, advancing the position past it.
+		// Returns the number of digits parsed (0 if there is no number) or -1 if the number does not fit in an int.
+		static int parse_number(char16_t const *&it, char16_t const *const end, int &number) noexcept {
+			while(it != end && QChar::isSpace(*it)) {
+				++it;
+			}
+			bool negative = false;
+			if(it != end && (*it == u'-' || *it == u'+')) {
+				negative = *it++ == u'-';
+			}
+
+			long long value = 0;
+			int digits = 0;
+			for(; it != end && *it >= u'0' && *it <= u'9'; ++it, ++digits) {
+				value = value * 10 + (*it - u'0');
+				if(value > static_cast<long long>(std::numeric_limits<int>::max()) + 1) {
+					return -1;
+				}
+			}
+			value = negative ? -value : value;
+			if(value > std::numeric_limits<int>::max()) {
+				return -1;
+			}
+			number = static_cast<int>(value);
+
+			return digits;
+		}
+
+		// Parses one end of a chapter or range of chapters (e.g. "1.2.3") into the given components.
+		// Returns false if the first component is not a number or any component does not fit in an int.
+		static bool parse_components(char16_t const *it, char16_t const *const end, Components &components) {
+			int number = 0;
+			if(parse_number(it, end, number) <= 0) {
+				return false;
+			}
+			components.push_back(number);
+
+			// Every period starts another component, which is 0 if it is not a number.
+			while((it = std::find(it, end, u'.')) != end) {
+				++it;
+				number = 0;
+				if(parse_number(it, end, number) < 0) {
+					return false;
+				}
+				components.push_back(number);
+			}
+
+			return true;
+		}
 
 		public:
 		// Constructor that takes a chapter in string form and converts it for use; empty upon failure.
-		explicit Chapter(QString const &chapter): l(), r() {
-			std::string const cs(chapter.toStdString());
-			// Index for the range symbol.
-			auto ri = cs.find('~'), npos = std::string::npos;
-
-			try {
-				// The given chapter is not a range.
-				if(ri == npos) {
-					// Fill the chapter components by parsing through each number token.
-					l.push_back(std::stoi(cs));
-					for(auto si = cs.find('.'); si != npos; si = cs.find('.', si + 1)) {
-						l.push_back(std::atoi(cs.data() + si + 1));
-					}
+		// Parses the UTF-16 data directly without allocating or throwing.
+		explicit Chapter(QStringView const chapter): l(), r() {
+			auto const begin = chapter.utf16(), end = begin + chapter.size();
+			// Position of the range symbol.
+			auto const ri = std::find(begin, end, u'~');
+
+			// If the given chapter is not a range, then the right end is the same as the left end;
+			// otherwise, continue the parse after the range symbol.
+			bool parsed = parse_components(begin, ri, l);
+			if(parsed) {
+				if(ri == end) {
 					r = l;
 				}
-				// The given chapter is a range.
 				else {
-					// Fill the left chapter components by parsing through each number token.
-					l.push_back(std::stoi(cs));
-					for(auto si = cs.find('.'); si != npos && si < ri; si = cs.find('.', si + 1)) {
-						l.push_back(std::atoi(cs.data() + si + 1));
-					}
-
-					// Fill the right chapter components by continuing the parse after the range symbol.
-					r.push_back(std::stoi(cs.data() + ri + 1));
-					for(auto si = cs.find('.', ri + 1); si != npos; si = cs.find('.', si + 1)) {
-						r.push_back(std::atoi(cs.data() + si + 1));
-					}
+					parsed = parse_components(ri + 1, end, r);
 				}
 			}
-			catch(std::exception const &) {
-				// The given string is not a chapter or range of chapters, so reset this chapter object to indicate failure.
+
+			// The given string is not a chapter or range of chapters, so reset this chapter object to indicate failure.
+			if(!parsed) {
 				l.clear(), r.clear();
 			}
 
@@ -74,24 +112,24 @@ namespace omm {
 		}
 
 		// Copy constructor.
-		Chapter(IntVector const &_l, IntVector const &_r): l(_l), r(_r) {}
+		Chapter(Components const &_l, Components const &_r): l(_l), r(_r) {}
 
 		// Move constructor.
-		Chapter(IntVector &&_l, IntVector &&_r): l(std::move(_l)), r(std::move(_r)) {}
+		Chapter(Components &&_l, Components &&_r): l(std::move(_l)), r(std::move(_r)) {}
 
-		IntVector &get_l() {
+		Components &get_l() {
 			return l;
 		}
 
-		IntVector &get_r() {
+		Components &get_r() {
 			return r;
 		}
 
-		IntVector const &get_l() const {
+		Components const &get_l() const {
 			return l;
 		}
 
-		IntVector const &get_r() const {
+		Components const &get_r() const {
 			return r;
 		}
 
@@ -111,7 +149,7 @@ namespace omm {
 				return ChapterState::DifferentDepth;
 			}
 
-			for(IntVector::size_type a = 0; a < l.size() - 1; ++a) {
+			for(Components::size_type a = 0; a < l.size() - 1; ++a) {
 				if(l[a] != r[a]) {
 					return ChapterState::MultiSection;
 				}
@@ -129,11 +167,11 @@ namespace omm {
 			return l <= other.get_r() && other.get_l() <= r;
 		}
 
-		// Serialize this chapter in JSON format.
-		void to_json(QJsonArray &json) const {
+		// Convert this chapter to string form.
+		QString to_string() const {
 			// Separate each component with a period and the range with a tilde, if applicable.
 			QString s;
-			for(IntVector::size_type a = 0; a < l.size(); ++a) {
+			for(Components::size_type a = 0; a < l.size(); ++a) {
 				if(a) {
 					s.append(u'.');
 				}
@@ -141,14 +179,19 @@ namespace omm {
 			}
 			if(l != r) {
 				s.append(u" ~ "_qs);
-				for(IntVector::size_type a = 0; a < r.size(); ++a) {
+				for(Components::size_type a = 0; a < r.size(); ++a) {
 					if(a) {
 						s.append(u'.');
 					}
 					s.append(QString::number(r[a]));
 				}
 			}
-			json.append(s);
+			return s;
+		}
+
+		// Serialize this chapter in JSON format.
+		void to_json(QJsonArray &json) const {
+			json.append(to_string());
 		}
 	};
 
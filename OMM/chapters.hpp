@@ -1,131 +1,637 @@
 #pragma once
 
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "chapter.hpp"
+#include "jsonreader.hpp"
+#include "jsonwriter.hpp"
+#include "profiler.hpp"
+#include "stringarena.hpp"
 
 // Exclusive namespace for the OMM.
 namespace omm {
 	// Alias.
 	using ChapterVector = std::vector<Chapter>;
 
+	// A range of single-level chapters (e.g. "1~500", or "123" with both ends the same) packed as its two ends;
+	// most chapters are like this, so they are kept in 8 bytes instead of a Chapter.
+	struct ChapterSpan {
+		int l;
+		int r;
+
+		// Convert this range of chapters to a chapter.
+		Chapter to_chapter() const {
+			return Chapter(Components{l}, Components{r});
+		}
+
+		// Convert this range of chapters to string form, the same way as Chapter::to_string().
+		QString to_string() const {
+			return l == r ? QString::number(l) : QString::number(l) + u" ~ "_qs + QString::number(r);
+		}
+	};
+
+	inline bool operator<(ChapterSpan const &l, ChapterSpan const &r) noexcept {
+		return l.l == r.l ? l.r < r.r : l.l < r.l;
+	}
+
+	// Alias.
+	using SpanVector = std::vector<ChapterSpan>;
+
+	// The states of the chapters in string form of a list of chapters (see Chapters).
+	enum class ParseState : unsigned char { Unparsed, Parsing, Parsed };
+
 	// The class that manages a list of chapters.
+	// The single-level ranges of chapters are packed apart from the deeper chapters (e.g. "3.1~3.5").
+	// A loaded list is kept in string form and only parsed the first time it is used,
+	// and a list that was never changed is saved back exactly as it was loaded.
+	// The parsing is safe from several threads at once, so the const functions may be called from any thread as long
+	// as the list is not changed meanwhile (e.g. by a view while the list is sorted or saved on another thread).
 	class Chapters {
 		private:
 		// The name of this list of chapters.
-		QString const name;
-		// The vector of chapters that this class manages.
-		ChapterVector chapters;
+		QString name;
+		// The chapters in string form as they were loaded, until the list is changed; only changed by the non-const
+		// functions, so that they may be read while the list is parsed on another thread.
+		QStringList raw;
+		// Whether the chapters in string form were parsed into the lists below yet; the thread that parses them sets
+		// it to Parsing first, and any other thread that needs them meanwhile waits for it to become Parsed.
+		mutable std::atomic<ParseState> state;
+		// The single-level ranges of chapters;
+		// always sorted, with no two ranges overlapping or following each other directly.
+		mutable SpanVector spans;
+		// The chapters deeper than one level, in the same order and with the same guarantees as the ranges;
+		// they are kept apart from the ranges even where a range covers them (e.g. "5.2" with "1~10"), so that they
+		// stay in the list once the range is split around them (see remove()).
+		mutable ChapterVector chapters;
 
-		public:
-		explicit Chapters(QString &&_name): name(std::move(_name)), chapters() {}
+		// Put the given chapter with the single-level ranges or the deeper chapters, leaving both to be organized.
+		void append(Chapter &&chapter) const {
+			if(chapter.get_l().size() == 1) {
+				spans.push_back(ChapterSpan{chapter.get_l()[0], chapter.get_r()[0]});
+			}
+			else {
+				chapters.push_back(std::move(chapter));
+			}
+		}
+
+		// Organize both the single-level ranges and the deeper chapters after chapters were put in them out of order.
+		void organize_all() const {
+			OMM_PROFILE_SCOPE(Organize, spans.size() + chapters.size());
+			organize(chapters);
+			merge_spans(spans);
+		}
 
-		// Merges the two given overlapping chapters into the first and erases the second from the list.
-		void merge_chapters(Chapter &c1, Chapter &c2) {
-			c1.get_l() = std::move(c1.get_l() > c2.get_l() ? c2.get_l() : c1.get_l());
-			c1.get_r() = std::move(c1.get_r() < c2.get_r() ? c2.get_r() : c1.get_r());
-			if(auto c2i = std::find(chapters.cbegin(), chapters.cend(), c2); c2i != chapters.cend()) {
-				chapters.erase(c2i);
+		// Parse the chapters in string form, if they were not yet.
+		void parse() const {
+			if(state.load(std::memory_order_acquire) == ParseState::Parsed) {
+				return;
 			}
+
+			ParseState expected = ParseState::Unparsed;
+			if(!state.compare_exchange_strong(expected, ParseState::Parsing, std::memory_order_acquire)) {
+				// Another thread is parsing them; parsing a list takes little time.
+				while(state.load(std::memory_order_acquire) != ParseState::Parsed) {
+					std::this_thread::yield();
+				}
+
+				return;
+			}
+
+			spans.clear();
+			chapters.clear();
+			spans.reserve(static_cast<SpanVector::size_type>(raw.size()));
+			for(auto const &a: raw) {
+				append(Chapter(a));
+			}
+			organize_all();
+			state.store(ParseState::Parsed, std::memory_order_release);
+		}
+
+		// Parse the chapters in string form, if they were not yet, and drop them before the list is changed.
+		void unpack() {
+			parse();
+			raw.clear();
+		}
+
+		// Returns the state of the chapters in string form once no thread is parsing them.
+		ParseState settled_state() const {
+			ParseState current = state.load(std::memory_order_acquire);
+			while(current == ParseState::Parsing) {
+				std::this_thread::yield();
+				current = state.load(std::memory_order_acquire);
+			}
+
+			return current;
+		}
+
+		// Returns the range of deeper chapters that the given single-level range covers;
+		// chapters such as "2.5" lie between "2" and "3", so "1~3" covers them while "1~2" does not.
+		std::pair<ChapterVector::iterator, ChapterVector::iterator> find_covered(ChapterSpan const &span) const {
+			auto const first = std::partition_point(chapters.begin(), chapters.end(), [&](Chapter const &c) {
+				return c.get_l()[0] < span.l;
+			});
+			auto const last = std::partition_point(first, chapters.end(), [&](Chapter const &c) {
+				return c.get_l()[0] < span.r;
+			});
+
+			return {first, last};
 		}
 
-		// Splits the list based on the given pivot chapter located in the list;
-		// the pivot chapter is removed.
-		void split_chapters(Chapter &chapter, Chapter &pivot) {
-			// If the leftmost chapter is the pivot chapter...
-			if(chapter.get_l() == pivot.get_l()) {
-				// ... and if the chapter is a single chapter, then remove it.
-				if(chapter.get_r() == pivot.get_l()) {
-					chapters.erase(std::find(chapters.cbegin(), chapters.cend(), chapter));
+		// Merge any overlapping or consecutive single-level ranges in a single pass over the given list, sorting it first.
+		static void merge_spans(SpanVector &spans) {
+			if(!std::is_sorted(spans.cbegin(), spans.cend())) {
+				std::sort(spans.begin(), spans.end());
+			}
+			if(spans.size() < 2) {
+				return;
+			}
+
+			auto merged = spans.begin();
+			for(auto si = std::next(merged); si != spans.end(); ++si) {
+				if(si->l <= static_cast<long long>(merged->r) + 1) {
+					merged->r = std::max(merged->r, si->r);
 				}
-				else {
-					// Otherwise, remove the leftmost chapter.
-					++chapter.get_l().back();
+				else if(++merged != si) {
+					*merged = *si;
 				}
 			}
-			else if(chapter.get_r() == pivot.get_l()) {
-				// If the rightmost chapter is the pivot chapter, then remove the rightmost chapter.
-				--chapter.get_r().back();
+			spans.erase(std::next(merged), spans.end());
+		}
+
+		// Returns true if the two given chapter ends are in the same section (same depth and same leading components).
+		static bool in_same_section(Components const &l, Components const &r) {
+			return l.size() == r.size() && std::equal(l.cbegin(), l.cend() - 1, r.cbegin());
+		}
+
+		// Returns true if the chapter starting at the given left end directly follows the given right end.
+		static bool are_consecutive(Components const &r, Components const &l) {
+			return in_same_section(r, l) && static_cast<long long>(r.back()) + 1 == l.back();
+		}
+
+		// Returns the range of chapters in the list that overlap the given chapter.
+		// Since the chapters are sorted and disjoint, both of their ends are sorted, so binary search works on either.
+		std::pair<ChapterVector::iterator, ChapterVector::iterator> find_overlapping(Chapter const &chapter) {
+			auto const first = std::partition_point(chapters.begin(), chapters.end(), [&](Chapter const &c) {
+				return c.get_r() < chapter.get_l();
+			});
+			auto const last = std::partition_point(first, chapters.end(), [&](Chapter const &c) {
+				return c.get_l() <= chapter.get_r();
+			});
+
+			return {first, last};
+		}
+
+		// Appends what remains of the given chapter after removing the given pivot chapter to the given list.
+		static void subtract(Chapter const &chapter, Chapter const &pivot, ChapterVector &remainder) {
+			bool const leftRemains = chapter.get_l() < pivot.get_l(), rightRemains = pivot.get_r() < chapter.get_r();
+
+			// If the pivot chapter covers the whole chapter, then nothing remains.
+			if(!leftRemains && !rightRemains) {
+				return;
 			}
-			else {
-				// Otherwise, split the range of chapters, and remove the pivot chapter.
-				--pivot.get_l().back();
-				chapters.insert(std::find(chapters.cbegin(), chapters.cend(), chapter),
-						Chapter(chapter.get_l(), pivot.get_l()));
-				pivot.get_l().back() += 2;
-				chapter.get_l() = std::move(pivot.get_l());
+
+			// Only chapters in the same section can be partially removed, so leave the chapter as is otherwise.
+			if(!in_same_section(chapter.get_l(), pivot.get_l())) {
+				remainder.push_back(chapter);
+
+				return;
+			}
+
+			// Keep the chapters before and after the pivot chapter.
+			if(leftRemains) {
+				Components r(pivot.get_l());
+				--r.back();
+				remainder.emplace_back(chapter.get_l(), std::move(r));
+			}
+			if(rightRemains) {
+				Components l(pivot.get_r());
+				++l.back();
+				remainder.emplace_back(std::move(l), chapter.get_r());
+			}
+		}
+
+		// Merge any overlapping or consecutive ranges of chapters in a single pass over the given sorted list.
+		static void merge_sorted(ChapterVector &chapters) {
+			if(chapters.size() < 2) {
+				return;
+			}
+
+			auto merged = chapters.begin();
+			for(auto ci = std::next(merged); ci != chapters.end(); ++ci) {
+				if(ci->get_l() <= merged->get_r() || are_consecutive(merged->get_r(), ci->get_l())) {
+					if(merged->get_r() < ci->get_r()) {
+						merged->get_r() = std::move(ci->get_r());
+					}
+				}
+				else if(++merged != ci) {
+					*merged = std::move(*ci);
+				}
+			}
+			chapters.erase(std::next(merged), chapters.end());
+		}
+
+		// Drop any chapters that failed to convert from the given list, sort it, and merge its chapters.
+		static void organize(ChapterVector &chapters) {
+			chapters.erase(std::remove_if(chapters.begin(), chapters.end(),
+								   [](Chapter const &c) {
+									   return c.get_l().empty();
+								   }),
+					chapters.end());
+
+			// Sort the list of chapters if needed, and merge the chapters.
+			if(!std::is_sorted(chapters.cbegin(), chapters.cend())) {
+				std::sort(chapters.begin(), chapters.end());
 			}
+			merge_sorted(chapters);
 		}
 
-		// Add the given chapter to the list.
-		void add(QString const &chapter) {
-			// Convert the given chapter into a convenient form.
-			Chapter toAdd(chapter);
+		public:
+		explicit Chapters(QString &&_name):
+				name(std::move(_name)), raw(), state(ParseState::Parsed), spans(), chapters() {}
+
+		// Copy constructor that leaves the chapters in string form for the copy to parse if they were not parsed yet;
+		// the list copied may be parsed on another thread meanwhile.
+		Chapters(Chapters const &other):
+				name(other.name), raw(other.raw), state(other.settled_state()), spans(), chapters() {
+			if(state == ParseState::Parsed) {
+				spans = other.spans;
+				chapters = other.chapters;
+			}
+		}
+
+		Chapters(Chapters &&other) noexcept:
+				name(std::move(other.name)), raw(std::move(other.raw)), state(other.state.load()),
+				spans(std::move(other.spans)), chapters(std::move(other.chapters)) {}
+
+		Chapters &operator=(Chapters const &other) {
+			if(this != &other) {
+				*this = Chapters(other);
+			}
+
+			return *this;
+		}
 
-			// If the given chapter overlaps with an existing chapter, then merge them.
-			for(auto &ac: chapters) {
-				if(ac.does_overlap(toAdd)) {
-					merge_chapters(ac, toAdd);
+		Chapters &operator=(Chapters &&other) noexcept {
+			name = std::move(other.name);
+			raw = std::move(other.raw);
+			state = other.state.load();
+			spans = std::move(other.spans);
+			chapters = std::move(other.chapters);
+
+			return *this;
+		}
+
+		// Getter for the name of this list of chapters.
+		QString const &get_name() const noexcept {
+			return name;
+		}
+
+		// Getter for the single-level ranges of chapters, which are sorted and do not overlap.
+		SpanVector const &get_spans() const {
+			parse();
+			return spans;
+		}
+
+		// Getter for the chapters deeper than one level, which are sorted and do not overlap.
+		ChapterVector const &get_multilevel() const {
+			parse();
+			return chapters;
+		}
+
+		// Returns the number of chapters and ranges of chapters in the list.
+		std::size_t size() const {
+			parse();
+			return spans.size() + chapters.size();
+		}
 
-					return;
+		// Call the given function with each chapter in string form, in order.
+		template<typename Function>
+		void for_each_string(Function &&function) const {
+			parse();
+			auto si = spans.cbegin();
+			for(auto const &a: chapters) {
+				// A single-level range comes before the deeper chapters that start within it (e.g. "2" before "2.1").
+				for(; si != spans.cend() && si->l <= a.get_l()[0]; ++si) {
+					function(si->to_string());
 				}
+				function(a.to_string());
+			}
+			for(; si != spans.cend(); ++si) {
+				function(si->to_string());
 			}
+		}
 
-			// Otherwise, simply add the given chapter.
-			chapters.push_back(std::move(toAdd));
+		// Replace the chapters in the list with the given ones, e.g. when decoding a saved list.
+		void assign(SpanVector &&_spans, ChapterVector &&_chapters) {
+			raw.clear();
+			state = ParseState::Parsed;
+			spans = std::move(_spans);
+			chapters = std::move(_chapters);
+			organize_all();
 		}
 
-		// Remove the given chapter from the list.
-		void remove(QString const &chapter) {
-			// Convert the given chapter into a convenient form.
-			Chapter toRemove(chapter);
+		// Add the given single-level range of chapters to the list, merging it with every range it overlaps or directly
+		// follows or precedes.
+		void add(ChapterSpan span) {
+			unpack();
+			auto const first = std::partition_point(spans.begin(), spans.end(), [&](ChapterSpan const &s) {
+				return static_cast<long long>(s.r) + 1 < span.l;
+			});
+			auto const last = std::partition_point(first, spans.end(), [&](ChapterSpan const &s) {
+				return s.l <= static_cast<long long>(span.r) + 1;
+			});
+			if(first == last) {
+				spans.insert(first, span);
+			}
+			else {
+				span.l = std::min(span.l, first->l);
+				span.r = std::max(span.r, std::prev(last)->r);
+				*first = span;
+				spans.erase(std::next(first), last);
+			}
+		}
+
+		// Add the given chapter to the list, merging it with every chapter it overlaps or directly follows or precedes.
+		void add(Chapter &&toAdd) {
+			// Ignore chapters that failed to convert.
+			if(toAdd.verify() != ChapterState::Valid) {
+				return;
+			}
 
-			// If the given chapter exists, then remove it.
-			for(auto &ac: chapters) {
-				if(ac.does_overlap(toRemove)) {
-					split_chapters(ac, toRemove);
+			if(toAdd.get_l().size() == 1) {
+				add(ChapterSpan{toAdd.get_l()[0], toAdd.get_r()[0]});
+
+				return;
+			}
 
-					return;
+			unpack();
+			auto [first, last] = find_overlapping(toAdd);
+			Components l(std::move(toAdd.get_l())), r(std::move(toAdd.get_r()));
+			if(first != last) {
+				if(first->get_l() < l) {
+					l = first->get_l();
 				}
+				if(r < std::prev(last)->get_r()) {
+					r = std::prev(last)->get_r();
+				}
+			}
+
+			// Also merge with the neighbouring chapters if they directly precede or follow the merged chapter.
+			if(first != chapters.begin() && are_consecutive(std::prev(first)->get_r(), l)) {
+				--first;
+				l = first->get_l();
+			}
+			if(last != chapters.end() && are_consecutive(r, last->get_l())) {
+				r = last->get_r();
+				++last;
+			}
+
+			// Replace all the merged chapters with the single merged chapter.
+			if(first == last) {
+				chapters.emplace(first, std::move(l), std::move(r));
+			}
+			else {
+				*first = Chapter(std::move(l), std::move(r));
+				chapters.erase(std::next(first), last);
 			}
 		}
 
-		// Fix any reversed ranges of chapters, sort the list, and merge any overlapping ranges of chapters.
-		void organize() {
-			// If the list of chapters has more than one element...
-			if(chapters.size() > 1) {
-				// ... then sort the list of chapters...
-				std::sort(chapters.begin(), chapters.end());
+		// Add the given chapter in string form to the list.
+		void add(QStringView const chapter) {
+			add(Chapter(chapter));
+		}
 
-				// ... and merge any overlapping ranges of chapters.
-				for(ChapterVector::size_type a = chapters.size() - 1; a > 0; --a) {
-					if(chapters[a - 1].does_overlap(chapters[a])) {
-						merge_chapters(chapters[a - 1], chapters[a]);
-					}
+		// Add all the given chapters to the list at once;
+		// the given chapters are sorted once and merged into the list in a single linear pass.
+		void add(ChapterVector &&toAdd) {
+			// Ignore chapters that failed to convert.
+			toAdd.erase(std::remove_if(toAdd.begin(), toAdd.end(),
+								[](Chapter const &c) {
+									return c.verify() != ChapterState::Valid;
+								}),
+					toAdd.end());
+
+			// A single chapter is cheaper to add on its own.
+			if(toAdd.size() == 1) {
+				add(std::move(toAdd.front()));
+
+				return;
+			}
+
+			if(!std::is_sorted(toAdd.cbegin(), toAdd.cend())) {
+				std::sort(toAdd.begin(), toAdd.end());
+			}
+
+			// Append the sorted chapters, merge the two sorted runs of each kind, and then merge the chapters themselves.
+			unpack();
+			auto const oldSpans = static_cast<SpanVector::difference_type>(spans.size());
+			auto const oldSize = static_cast<ChapterVector::difference_type>(chapters.size());
+			for(auto &a: toAdd) {
+				append(std::move(a));
+			}
+			std::inplace_merge(spans.begin(), spans.begin() + oldSpans, spans.end());
+			std::inplace_merge(chapters.begin(), chapters.begin() + oldSize, chapters.end());
+			organize_all();
+		}
+
+		// Add all the given chapters in string form to the list at once.
+		void add(QStringList const &toAdd) {
+			ChapterVector parsed;
+			parsed.reserve(toAdd.size());
+			for(auto const &a: toAdd) {
+				parsed.emplace_back(a);
+			}
+			add(std::move(parsed));
+		}
+
+		// Add all the chapters in the given text to the list at once;
+		// the chapters are separated by commas, semicolons, or line breaks (e.g. "1~50, 52, 60.1~60.9").
+		void import(QStringView const text) {
+			add(parse_list(text));
+		}
+
+		// Convert the chapters in the given text separated by commas, semicolons, or line breaks;
+		// any chapters that fail to convert are left out.
+		static ChapterVector parse_list(QStringView const text) {
+			ChapterVector parsed;
+			auto const end = text.utf16() + text.size();
+			for(auto begin = text.utf16(); begin < end;) {
+				auto const separator = std::find_if(begin, end, [](char16_t const c) {
+					return c == u',' || c == u';' || c == u'\n' || c == u'\r';
+				});
+				if(Chapter chapter(QStringView(begin, separator)); !chapter.get_l().empty()) {
+					parsed.push_back(std::move(chapter));
+				}
+				begin = separator + 1;
+			}
+
+			return parsed;
+		}
+
+		// Remove the given single-level range of chapters from the list, splitting every range it overlaps,
+		// along with the deeper chapters that it covers (see find_covered()); the deeper chapters that the split ranges
+		// covered outside it (e.g. "5.2" when removing "3~5" from "1~10") stay.
+		void remove(ChapterSpan const &span) {
+			unpack();
+			auto const first = std::partition_point(spans.begin(), spans.end(), [&](ChapterSpan const &s) {
+				return s.r < span.l;
+			});
+			auto const last = std::partition_point(first, spans.end(), [&](ChapterSpan const &s) {
+				return s.l <= span.r;
+			});
+			if(first != last) {
+				// Keep the chapters before and after the removed range.
+				SpanVector remainder;
+				if(first->l < span.l) {
+					remainder.push_back(ChapterSpan{first->l, span.l - 1});
 				}
+				if(span.r < std::prev(last)->r) {
+					remainder.push_back(ChapterSpan{span.r + 1, std::prev(last)->r});
+				}
+				auto const position = spans.erase(first, last);
+				spans.insert(position, remainder.cbegin(), remainder.cend());
 			}
+
+			auto const [coveredFirst, coveredLast] = find_covered(span);
+			chapters.erase(coveredFirst, coveredLast);
 		}
 
-		// Serialize this list of chapters in JSON format.
+		// Remove the given chapter from the list, splitting every chapter it overlaps.
+		void remove(Chapter const &toRemove) {
+			// Ignore chapters that failed to convert.
+			if(toRemove.verify() != ChapterState::Valid) {
+				return;
+			}
+
+			if(toRemove.get_l().size() == 1) {
+				remove(ChapterSpan{toRemove.get_l()[0], toRemove.get_r()[0]});
+
+				return;
+			}
+
+			// A single-level range is never split by a deeper chapter, so only the deeper chapters can change.
+			unpack();
+			auto const [first, last] = find_overlapping(toRemove);
+			if(first == last) {
+				return;
+			}
+
+			// Only the chapters at both ends can be partially removed;
+			// the ones in between are covered entirely by the removed chapter.
+			ChapterVector remainder;
+			subtract(*first, toRemove, remainder);
+			if(std::next(first) != last) {
+				subtract(*std::prev(last), toRemove, remainder);
+			}
+
+			auto const position = chapters.erase(first, last);
+			chapters.insert(position, std::make_move_iterator(remainder.begin()), std::make_move_iterator(remainder.end()));
+		}
+
+		// Remove the given chapter in string form from the list.
+		void remove(QStringView const chapter) {
+			remove(Chapter(chapter));
+		}
+
+		// Sort the list and merge any overlapping or consecutive ranges of chapters;
+		// only needed after the list was filled from outside, since add and remove keep it organized.
+		// A list that was never changed since it was loaded is organized by parse() instead.
+		void organize() {
+			if(!raw.isEmpty()) {
+				return;
+			}
+			organize_all();
+		}
+
+		// Serialize this list of chapters in JSON format; a list that was never parsed is written as it was loaded.
 		void to_json(QJsonObject &json) const {
-			QJsonArray chaptersArray;
-			for(auto const &a: chapters) {
-				a.to_json(chaptersArray);
+			if(!raw.isEmpty()) {
+				json[name] = QJsonArray::fromStringList(raw);
+
+				return;
 			}
+
+			QJsonArray chaptersArray;
+			for_each_string([&](QString const &chapter) {
+				chaptersArray.append(chapter);
+			});
 			json[name] = chaptersArray;
 		}
 
-		// Reconstruct this list of chapters from JSON data.
+		// Serialize this list of chapters as the value of the current member of the given writer.
+		// A list that was never parsed is written as it was loaded.
+		void to_writer(JsonWriter &writer) const {
+			writer.begin_array();
+			for(auto const &a: raw) {
+				writer.element(a);
+			}
+			if(raw.isEmpty()) {
+				for_each_string([&](QString const &chapter) {
+					writer.element(chapter);
+				});
+			}
+			writer.end_array();
+		}
+
+		// Reconstruct this list of chapters from JSON data, keeping the chapters in string form until they are used.
 		void from_json(const QJsonObject &json) {
+			spans.clear();
 			chapters.clear();
-			QJsonArray chaptersArray = json[name].toArray();
-			chapters.reserve(chaptersArray.size());
+			raw.clear();
+			QJsonArray const chaptersArray = json[name].toArray();
+			raw.reserve(chaptersArray.size());
 			for(auto const &a: chaptersArray) {
-				chapters.push_back(Chapter(a.toString()));
+				if(a.isString()) {
+					raw.append(a.toString());
+				}
+			}
+			state = raw.isEmpty() ? ParseState::Parsed : ParseState::Unparsed;
+		}
+
+		// Give each chapter in string form memory of its own, so that it no longer depends on the buffers of the
+		// StringArena that it was loaded into.
+		void own_strings() {
+			for(auto &a: raw) {
+				own(a);
 			}
 		}
+
+		// Reconstruct this list of chapters from the array that the given reader is at,
+		// keeping the chapters in string form, stored in the given arena, until they are used.
+		bool from_reader(JsonReader &reader, StringArena &arena) {
+			spans.clear();
+			chapters.clear();
+			raw.clear();
+			state = ParseState::Parsed;
+			if(reader.peek_type() != JsonType::Array) {
+				return reader.skip_value();
+			}
+
+			reader.enter_array();
+			QString chapter;
+			while(reader.next_element()) {
+				if(reader.peek_type() == JsonType::String) {
+					reader.read_string(chapter, arena);
+					raw.append(std::move(chapter));
+				}
+				else {
+					reader.skip_value();
+				}
+			}
+			state = raw.isEmpty() ? ParseState::Parsed : ParseState::Unparsed;
+
+			return !reader.has_error();
+		}
 	};
 } // namespace omm
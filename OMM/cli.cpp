@@ -0,0 +1,310 @@
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "generator.hpp"
+#include "profiler.hpp"
+#include "save.hpp"
+
+namespace omm {
+	// Returns true if the file at the given path is a binary save rather than a JSON one.
+	static bool is_binary(QString const &path) {
+		return path.endsWith(u".bin"_qs);
+	}
+
+	// Load the save at the given path in the format that its name says.
+	static bool load_any(Save &save, QString const &path) {
+		return is_binary(path) ? save.load_binary(path) : save.load(path);
+	}
+
+	// Save the save to the given path in the format that its name says.
+	static bool save_any(Save &save, QString const &path) {
+		return is_binary(path) ? save.save_binary(path) : save.save(path);
+	}
+
+	// Add the entries of the save at the given path that the save does not have yet.
+	static bool import_entries(Save &save, QString const &path, QTextStream &out) {
+		Save source;
+		if(!load_any(source, path)) {
+			return false;
+		}
+
+		EntryVector::size_type added = 0;
+		for(EntryVector::size_type a = 0; a < source.size(); ++a) {
+			Entry const &entry = source.get_entry(a);
+			if(!save.contains_entry(entry)) {
+				// The ID of the entry belongs to the other save.
+				Entry imported(entry);
+				imported.set_id(0);
+				save.add_entry(std::move(imported));
+				++added;
+			}
+		}
+		out << u"Imported %1 of %2 entries."_qs.arg(added).arg(source.size()) << Qt::endl;
+
+		return true;
+	}
+
+	// Check the save for problems, reporting each one; returns true if there are none.
+	static bool validate(Save &save, QTextStream &out) {
+		bool valid = true;
+		if(!save.verify_counts()) {
+			out << u"The counts do not match the entries."_qs << Qt::endl;
+			valid = false;
+		}
+
+		for(EntryVector::size_type a = 0; a < save.size(); ++a) {
+			if(auto const first = save.find_entry(save.get_entry(a)); first != a) {
+				out << u"Entry %1 is a duplicate of entry %2."_qs.arg(a).arg(first) << Qt::endl;
+				valid = false;
+			}
+		}
+
+		// The entries are kept sorted, so sorting them again should not move any.
+		auto const order = save.refresh();
+		for(std::size_t a = 0; a < order.size(); ++a) {
+			if(order[a] != a) {
+				out << u"The entries are not sorted (entry %1 should come at %2)."_qs.arg(order[a]).arg(a) << Qt::endl;
+				valid = false;
+				break;
+			}
+		}
+
+		if(valid) {
+			out << u"No problems found in %1 entries."_qs.arg(save.size()) << Qt::endl;
+		}
+
+		return valid;
+	}
+
+	// Write the given group of counts, largest first.
+	static void write_counts(QTextStream &out, Counts const &counts) {
+		std::vector<std::pair<QString, int>> sorted(counts.cbegin(), counts.cend());
+		std::stable_sort(sorted.begin(), sorted.end(), [](auto const &l, auto const &r) {
+			return l.second > r.second;
+		});
+
+		out << counts.get_name() << u':' << Qt::endl;
+		for(auto const &[key, count]: sorted) {
+			if(count) {
+				out << u"  "_qs << key << u": "_qs << count << Qt::endl;
+			}
+		}
+	}
+
+	// Write the counts and other statistics of the save.
+	static void stats(Save const &save, QTextStream &out) {
+		std::size_t liked = 0, loved = 0;
+		for(EntryVector::size_type a = 0; a < save.size(); ++a) {
+			liked += save.get_entry(a).get_likedChapters().size();
+			loved += save.get_entry(a).get_lovedChapters().size();
+		}
+
+		out << u"Entries: "_qs << save.size() << Qt::endl;
+		out << u"Liked chapter ranges: "_qs << liked << Qt::endl;
+		out << u"Loved chapter ranges: "_qs << loved << Qt::endl;
+		write_counts(out, save.get_countsByType());
+		write_counts(out, save.get_countsByLanguage());
+		write_counts(out, save.get_countsByProgress());
+	}
+
+	// Apply the chapter marks read from the given stream, one per line in the form
+	// "add|delete liked|loved <entry index> <chapters>", where the chapters are as in Chapters::import()
+	// (e.g. "add liked 12 1~50, 52"); the chapters of a line are added at once, but deleted one by one.
+	// Returns false if any line could not be applied.
+	static bool mark_chapters(Save &save, QTextStream &in, QTextStream &err) {
+		static QRegularExpression const pattern(uR"(^\s*(add|delete)\s+(liked|loved)\s+(\d+)\s+(.+)$)"_qs);
+
+		bool applied = true;
+		QString line;
+		for(int number = 1; in.readLineInto(&line); ++number) {
+			if(line.trimmed().isEmpty()) {
+				continue;
+			}
+
+			auto const match = pattern.match(line);
+			bool isIndex = false;
+			auto const index = match.hasMatch() ? match.captured(3).toULongLong(&isIndex) : 0;
+			if(!match.hasMatch() || !isIndex || index >= save.size()) {
+				err << u"Skipped line %1: expected \"add|delete liked|loved <entry index> <chapters>\"."_qs.arg(number)
+					<< Qt::endl;
+				applied = false;
+				continue;
+			}
+
+			ChapterList const cl = match.captured(2) == u"liked"_qs ? ChapterList::liked : ChapterList::loved;
+			if(match.captured(1) == u"add"_qs) {
+				save.import_chapters(index, match.captured(4), cl);
+				continue;
+			}
+			for(auto const &chapter: Chapters::parse_list(match.captured(4))) {
+				save.delete_chapter(index, chapter.to_string(), cl);
+			}
+		}
+
+		return applied;
+	}
+
+#ifdef OMM_PROFILE
+	// The class that writes the counts and the trace of the profiler to the given files, if any, once it goes out of
+	// scope, so that they are written however the command ends.
+	class ProfileFiles {
+		private:
+		// The path to write the counts to as JSON, or empty.
+		QString countsPath;
+		// The path to write the trace to in the Chrome trace format, or empty.
+		QString tracePath;
+
+		public:
+		// Constructor that takes the paths to write the counts and the trace to.
+		ProfileFiles(QString _countsPath, QString _tracePath):
+				countsPath(std::move(_countsPath)), tracePath(std::move(_tracePath)) {}
+
+		ProfileFiles(ProfileFiles const &) = delete;
+		ProfileFiles &operator=(ProfileFiles const &) = delete;
+
+		~ProfileFiles() {
+			QTextStream err(stderr);
+			if(!countsPath.isEmpty() && !Profiler::write(countsPath, Profiler::to_json())) {
+				err << u"Could not write %1."_qs.arg(countsPath) << Qt::endl;
+			}
+			if(!tracePath.isEmpty() && !Profiler::write(tracePath, Profiler::to_trace())) {
+				err << u"Could not write %1."_qs.arg(tracePath) << Qt::endl;
+			}
+		}
+	};
+#endif
+} // namespace omm
+
+int main(int argc, char *argv[]) {
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName(u"omm-cli"_qs);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(u"Runs the maintenance of an OMM save without the GUI.\n\n"
+									 "Commands:\n"
+									 "  import <file>    Add the entries of another save that the save does not have yet.\n"
+									 "  export <file>    Write the save to another file (binary if it ends in \".bin\").\n"
+									 "  refresh          Sort the entries and save.\n"
+									 "  validate         Check the counts, duplicates, and order of the entries.\n"
+									 "  stats            Show the counts of the entries.\n"
+									 "  chapters         Apply chapter marks read from the standard input, one per line:\n"
+									 "                   add|delete liked|loved <entry index> <chapters>\n"
+									 "  generate <file>  Write a synthetic library of --entries entries decided by --seed."_qs);
+	parser.addHelpOption();
+	QCommandLineOption const saveOption({u"s"_qs, u"save"_qs},
+			u"The save to work on (binary if it ends in \".bin\"; default: omm.json)."_qs, u"path"_qs, u"omm.json"_qs);
+	QCommandLineOption const threadsOption({u"t"_qs, u"threads"_qs},
+			u"The number of threads to use (default: one per core)."_qs, u"count"_qs, u"0"_qs);
+	QCommandLineOption const entriesOption({u"n"_qs, u"entries"_qs},
+			u"The number of entries of a synthetic library (default: 10000)."_qs, u"count"_qs, u"10000"_qs);
+	QCommandLineOption const seedOption(
+			u"seed"_qs, u"The seed that decides a synthetic library (default: 1)."_qs, u"number"_qs, u"1"_qs);
+	parser.addOption(saveOption);
+	parser.addOption(threadsOption);
+	parser.addOption(entriesOption);
+	parser.addOption(seedOption);
+#ifdef OMM_PROFILE
+	QCommandLineOption const profileOption(
+			u"profile"_qs, u"Write the counts of the profiler to the given file as JSON."_qs, u"path"_qs);
+	QCommandLineOption const traceOption(
+			u"trace"_qs, u"Write the trace of the profiler to the given file in the Chrome trace format."_qs, u"path"_qs);
+	parser.addOption(profileOption);
+	parser.addOption(traceOption);
+#endif
+	parser.addPositionalArgument(
+			u"command"_qs, u"import, export, refresh, validate, stats, chapters, or generate."_qs);
+	parser.addPositionalArgument(u"file"_qs, u"The file to import from, export to, or generate."_qs, u"[file]"_qs);
+	parser.process(app);
+
+	QTextStream out(stdout), err(stderr), in(stdin);
+	QStringList const arguments = parser.positionalArguments();
+	QString const command = arguments.value(0);
+	QStringList const commands{u"import"_qs, u"export"_qs, u"refresh"_qs, u"validate"_qs, u"stats"_qs,
+			u"chapters"_qs, u"generate"_qs};
+	bool const needsFile = command == u"import"_qs || command == u"export"_qs || command == u"generate"_qs;
+	if(!commands.contains(command) || arguments.size() != (needsFile ? 2 : 1)) {
+		parser.showHelp(2);
+	}
+
+#ifdef OMM_PROFILE
+	omm::ProfileFiles const profileFiles(parser.value(profileOption), parser.value(traceOption));
+#endif
+
+	unsigned const threads = parser.value(threadsOption).toUInt();
+	std::size_t const count = parser.value(entriesOption).toULongLong();
+	quint64 const seed = parser.value(seedOption).toULongLong();
+	// Synthetic libraries do not touch the save.
+	if(command == u"generate"_qs) {
+		omm::Generator generator(seed);
+		omm::Entries entries;
+		entries.set_thread_count(threads);
+		generator.generate(entries, count);
+		if(!omm::Generator::write(arguments.at(1), entries)) {
+			err << u"Could not write %1."_qs.arg(arguments.at(1)) << Qt::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	omm::Save save;
+	save.set_thread_count(threads);
+	QString const path = parser.value(saveOption);
+	// Importing into a save that does not exist yet starts a new one.
+	bool const startsNew = command == u"import"_qs && !QFile::exists(path);
+	if(!startsNew && !omm::load_any(save, path)) {
+		err << u"Could not load %1."_qs.arg(path) << Qt::endl;
+		return 1;
+	}
+	err << u"Loaded %1 entries in %2 ms."_qs.arg(save.size()).arg(timer.restart()) << Qt::endl;
+
+	// The edits are journaled, so they are saved like the GUI saves them (see Save::save_changes()); only a new save
+	// and a sorted one, whose order is not journaled, are written in full.
+	bool succeeded = true, fullSave = false;
+	if(command == u"import"_qs) {
+		succeeded = omm::import_entries(save, arguments.at(1), out);
+		fullSave = startsNew && succeeded;
+	}
+	else if(command == u"export"_qs) {
+		succeeded = omm::save_any(save, arguments.at(1));
+	}
+	else if(command == u"refresh"_qs) {
+		// The counts are kept up to date by each edit, so sorting is all there is to do.
+		save.refresh();
+		fullSave = true;
+	}
+	else if(command == u"validate"_qs) {
+		succeeded = omm::validate(save, out);
+	}
+	else if(command == u"stats"_qs) {
+		omm::stats(save, out);
+	}
+	else if(command == u"chapters"_qs) {
+		succeeded = omm::mark_chapters(save, in, err);
+	}
+	err << u"Ran %1 in %2 ms."_qs.arg(command).arg(timer.restart()) << Qt::endl;
+
+	bool saved = true;
+	if(fullSave) {
+		saved = startsNew ? omm::save_any(save, path) : save.save_file();
+	}
+	else if(save.has_unsaved_changes()) {
+		saved = save.save_changes();
+	}
+	if(!saved) {
+		err << u"Could not save %1."_qs.arg(path) << Qt::endl;
+		return 1;
+	}
+
+	return succeeded ? 0 : 1;
+}
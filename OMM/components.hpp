@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The class that stores the components of a chapter (volume.chapter.part...);
+	// up to inlineCapacity components are stored inline without any heap allocation.
+	class Components {
+		public:
+		using value_type = int;
+		using size_type = std::size_t;
+		using iterator = int *;
+		using const_iterator = int const *;
+
+		// The number of components that fit without a heap allocation.
+		static constexpr size_type inlineCapacity = 4;
+
+		private:
+		// The inline storage used while the components fit.
+		int buffer[inlineCapacity];
+		// The heap storage used once the components no longer fit inline.
+		std::unique_ptr<int[]> heap;
+		// The number of components.
+		size_type count;
+		// The number of components that fit in the current storage.
+		size_type capacity;
+
+		// Grow the storage so that at least the given number of components fit.
+		void grow(size_type const minimum) {
+			size_type newCapacity = std::max(capacity * 2, minimum);
+			auto newHeap = std::make_unique<int[]>(newCapacity);
+			std::copy(cbegin(), cend(), newHeap.get());
+			heap = std::move(newHeap);
+			capacity = newCapacity;
+		}
+
+		public:
+		// Default constructor that creates an empty list of components.
+		Components() noexcept: buffer(), heap(), count(0), capacity(inlineCapacity) {}
+
+		// Constructor that takes the components directly.
+		Components(std::initializer_list<int> list): Components() {
+			reserve(list.size());
+			std::copy(list.begin(), list.end(), begin());
+			count = list.size();
+		}
+
+		// Copy constructor.
+		Components(Components const &other): Components() {
+			reserve(other.count);
+			std::copy(other.cbegin(), other.cend(), begin());
+			count = other.count;
+		}
+
+		// Move constructor.
+		Components(Components &&other) noexcept: Components() {
+			swap(other);
+		}
+
+		// Copy assignment operator.
+		Components &operator=(Components const &other) {
+			if(this != &other) {
+				count = 0;
+				reserve(other.count);
+				std::copy(other.cbegin(), other.cend(), begin());
+				count = other.count;
+			}
+
+			return *this;
+		}
+
+		// Move assignment operator.
+		Components &operator=(Components &&other) noexcept {
+			if(this != &other) {
+				Components temp(std::move(other));
+				swap(temp);
+			}
+
+			return *this;
+		}
+
+		// Swap the contents of this list of components with the given one.
+		void swap(Components &other) noexcept {
+			std::swap(buffer, other.buffer);
+			std::swap(heap, other.heap);
+			std::swap(count, other.count);
+			std::swap(capacity, other.capacity);
+		}
+
+		// Make sure that the given number of components fit without a reallocation.
+		void reserve(size_type const minimum) {
+			if(minimum > capacity) {
+				grow(minimum);
+			}
+		}
+
+		// Append the given component.
+		void push_back(int const component) {
+			if(count == capacity) {
+				grow(count + 1);
+			}
+			begin()[count++] = component;
+		}
+
+		// Remove all components while keeping the storage.
+		void clear() noexcept {
+			count = 0;
+		}
+
+		int *data() noexcept {
+			return heap ? heap.get() : buffer;
+		}
+
+		int const *data() const noexcept {
+			return heap ? heap.get() : buffer;
+		}
+
+		size_type size() const noexcept {
+			return count;
+		}
+
+		bool empty() const noexcept {
+			return count == 0;
+		}
+
+		int &operator[](size_type const index) noexcept {
+			return data()[index];
+		}
+
+		int const &operator[](size_type const index) const noexcept {
+			return data()[index];
+		}
+
+		int &back() noexcept {
+			return data()[count - 1];
+		}
+
+		int const &back() const noexcept {
+			return data()[count - 1];
+		}
+
+		iterator begin() noexcept {
+			return data();
+		}
+
+		iterator end() noexcept {
+			return data() + count;
+		}
+
+		const_iterator begin() const noexcept {
+			return data();
+		}
+
+		const_iterator end() const noexcept {
+			return data() + count;
+		}
+
+		const_iterator cbegin() const noexcept {
+			return data();
+		}
+
+		const_iterator cend() const noexcept {
+			return data() + count;
+		}
+	};
+
+	inline bool operator==(Components const &l, Components const &r) {
+		return std::equal(l.cbegin(), l.cend(), r.cbegin(), r.cend());
+	}
+
+	inline bool operator!=(Components const &l, Components const &r) {
+		return !(l == r);
+	}
+
+	// Lexicographical comparison, the same as for std::vector.
+	inline bool operator<(Components const &l, Components const &r) {
+		return std::lexicographical_compare(l.cbegin(), l.cend(), r.cbegin(), r.cend());
+	}
+
+	inline bool operator>(Components const &l, Components const &r) {
+		return r < l;
+	}
+
+	inline bool operator<=(Components const &l, Components const &r) {
+		return !(r < l);
+	}
+
+	inline bool operator>=(Components const &l, Components const &r) {
+		return !(l < r);
+	}
+} // namespace omm
@@ -0,0 +1,26 @@
+# The core of the OMM without the GUI (the entries, chapters, and saves), for the projects that build it on their own.
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+	$$PWD/chapter.cpp \
+	$$PWD/entry.cpp
+
+HEADERS += \
+	$$PWD/binaryformat.hpp \
+	$$PWD/chapter.hpp \
+	$$PWD/chapters.hpp \
+	$$PWD/components.hpp \
+	$$PWD/counts.hpp \
+	$$PWD/entries.hpp \
+	$$PWD/entry.hpp \
+	$$PWD/facets.hpp \
+	$$PWD/field.hpp \
+	$$PWD/journal.hpp \
+	$$PWD/jsonreader.hpp \
+	$$PWD/jsonwriter.hpp \
+	$$PWD/parallel.hpp \
+	$$PWD/profiler.hpp \
+	$$PWD/progress.hpp \
+	$$PWD/save.hpp \
+	$$PWD/searchindex.hpp \
+	$$PWD/stringarena.hpp
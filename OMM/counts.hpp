@@ -5,6 +5,9 @@
 #include <map>
 #include <utility>
 
+#include "jsonreader.hpp"
+#include "jsonwriter.hpp"
+
 // Exclusive namespace for the OMM.
 namespace omm {
 	// The class that manages a group of counts of entries separated using an element as the standard.
@@ -19,6 +22,16 @@ namespace omm {
 		// Constructor that takes a string as the name for this group of counts.
 		explicit Counts(QString &&_name): name(std::move(_name)) {}
 
+		// Getter for the name of this group of counts.
+		QString const &get_name() const noexcept {
+			return name;
+		}
+
+		// Remove all counts.
+		void clear() noexcept {
+			counts.clear();
+		}
+
 		// Overload of the subscript operator that accesses the underlying map object.
 		auto &operator[](QString const &key) {
 			return counts[key];
@@ -44,6 +57,15 @@ namespace omm {
 			return counts.cend();
 		}
 
+		// Returns true if both groups of counts hold the same counts.
+		bool operator==(Counts const &other) const {
+			return counts == other.counts;
+		}
+
+		bool operator!=(Counts const &other) const {
+			return !(*this == other);
+		}
+
 		// Serialize this group of counts in JSON format.
 		void to_json(QJsonObject &json) const {
 			QJsonObject countsObject;
@@ -53,6 +75,15 @@ namespace omm {
 			json[name] = countsObject;
 		}
 
+		// Serialize this group of counts as a member of the current object of the given writer.
+		void to_writer(JsonWriter &writer) const {
+			writer.begin_object(name);
+			for(auto const &a: counts) {
+				writer.member(a.first, a.second);
+			}
+			writer.end_object();
+		}
+
 		// Reconstruct this group of counts from JSON data.
 		void from_json(const QJsonObject &json) {
 			counts.clear();
@@ -63,5 +94,27 @@ namespace omm {
 				}
 			}
 		}
+
+		// Reconstruct this group of counts from the object that the given reader is at.
+		bool from_reader(JsonReader &reader) {
+			counts.clear();
+			if(reader.peek_type() != JsonType::Object) {
+				return reader.skip_value();
+			}
+
+			reader.enter_object();
+			QString key;
+			while(reader.next_key(key)) {
+				if(qint64 count; reader.peek_type() == JsonType::Number && reader.read_integer(count)) {
+					counts[key] = static_cast<int>(count);
+				}
+				else {
+					counts[key] = 0;
+					reader.skip_value();
+				}
+			}
+
+			return !reader.has_error();
+		}
 	};
 } // namespace omm
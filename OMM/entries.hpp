@@ -4,53 +4,398 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QString>
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "binaryformat.hpp"
 #include "entry.hpp"
+#include "facets.hpp"
+#include "parallel.hpp"
+#include "profiler.hpp"
+#include "progress.hpp"
+#include "searchindex.hpp"
 
 // Exclusive namespace for the OMM.
 namespace omm {
 	// Alias.
 	using EntryVector = std::vector<Entry>;
 
+	// The iterator over a list of entries in list order, given the slots that hold the entries and the order of slots.
+	template<typename Value>
+	class EntryIterator {
+		private:
+		// The slots that hold the entries.
+		Value *storage;
+		// The current place in the order of slots.
+		std::vector<EntryVector::size_type>::const_iterator current;
+
+		public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Entry;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Value *;
+		using reference = Value &;
+
+		EntryIterator(Value *const _storage, std::vector<EntryVector::size_type>::const_iterator const _current):
+				storage(_storage), current(_current) {}
+
+		reference operator*() const {
+			return storage[*current];
+		}
+
+		pointer operator->() const {
+			return storage + *current;
+		}
+
+		EntryIterator &operator++() {
+			++current;
+			return *this;
+		}
+
+		EntryIterator operator++(int) {
+			EntryIterator const copy(*this);
+			++current;
+			return copy;
+		}
+
+		bool operator==(EntryIterator const &other) const {
+			return current == other.current;
+		}
+
+		bool operator!=(EntryIterator const &other) const {
+			return current != other.current;
+		}
+	};
+
 	// The class that manages a list of entries.
+	// Each entry has a stable ID and stays in the same slot from when it is added until it is deleted or the list is
+	// compacted; the list itself is the order of the slots, so sorting or deleting entries never moves them.
+	// A deleted entry leaves its slot empty (a tombstone) for the next added entry, and compact() drops the
+	// tombstones and moves the entries into list order, which is done on each full save.
 	class Entries {
 		private:
 		// The name of this list of entries.
 		QString const name;
-		// The vector containing the list of entries.
-		EntryVector entries;
+		// The slots holding the entries, including the empty slots of deleted entries; entries loaded from a binary
+		// save are decoded on first access, which may happen through const functions.
+		mutable EntryVector entries;
+		// The slot of the entry at each index of the list.
+		std::vector<EntryVector::size_type> order;
+		// The empty slots of deleted entries, to reuse for the next added entries.
+		std::vector<EntryVector::size_type> freeSlots;
+		// The slot of each entry by its ID.
+		std::unordered_map<EntryId, EntryVector::size_type> slotsById;
+		// The ID to give the next entry; IDs are never reused, even those of deleted entries.
+		EntryId nextId;
+		// The index of the entry in each slot; built on the first lookup and kept up to date until entries are
+		// reordered.
+		mutable std::vector<EntryVector::size_type> positions;
+		// Set while positions matches the order of the entries.
+		mutable bool positioned;
+		// The mapped binary save that the entries not decoded yet come from, if any.
+		mutable std::shared_ptr<BinaryImage const> image;
+		// For each slot, whether its entry has been decoded from the binary save yet; empty when there is no binary
+		// save. Entries are not moved between slots while there is one, so each slot matches the entry in the save.
+		mutable std::vector<bool> decoded;
+		// The slots of the entries by the hash of their title, type, author, and year;
+		// built on the first lookup and kept up to date by each edit from then on.
+		mutable std::unordered_multimap<std::size_t, EntryVector::size_type> identityIndex;
+		// Set while identityIndex matches the entries.
+		mutable bool indexed;
+		// The full-text index of the searchable fields of the entries;
+		// built on the first search and kept up to date by each edit from then on.
+		mutable SearchIndex searchIndex;
+		// Set while searchIndex matches the entries.
+		mutable bool searchIndexed;
+		// The bitmaps of the entries with each value of each facet;
+		// built on the first filter and kept up to date by each edit from then on.
+		mutable Facets facets;
+		// Set while facets matches the entries.
+		mutable bool facetsIndexed;
 		// The QCollator object to inject into each entry.
 		QCollator collator;
+		// The number of threads to use for sorting (0 for one per hardware thread, 1 for no extra threads).
+		unsigned threadCount;
+		// The buffers of the StringArena that the entries were loaded into by from_reader(), whose field values are
+		// views of them; shared with any copy of this list, and given up only when the entries are replaced.
+		std::vector<QString> stringBuffers;
+
+		// Create a collator with the settings used for comparing entries.
+		static QCollator make_collator() {
+			QCollator c;
+			c.setCaseSensitivity(Qt::CaseSensitivity::CaseInsensitive);
+			c.setIgnorePunctuation(false);
+			c.setNumericMode(true);
+			return c;
+		}
+
+		// Decode the entry in the given slot from the binary save if that has not been done yet.
+		void materialize(EntryVector::size_type const slot) const {
+			if(image && slot < decoded.size() && !decoded[slot]) {
+				image->decode_entry(static_cast<quint32>(slot), entries[slot]);
+				decoded[slot] = true;
+			}
+		}
+
+		// Decode every entry that has not been decoded yet and let go of the binary save,
+		// which must be done before the entries are moved between slots.
+		void materialize_all() const {
+			if(!image) {
+				return;
+			}
+
+			unsigned const threads = resolve_thread_count(threadCount, entries.size());
+			parallel_chunks(entries.size(), threads, [&](EntryVector::size_type const begin, EntryVector::size_type const end) {
+				for(auto a = begin; a < end; ++a) {
+					if(!decoded[a]) {
+						image->decode_entry(static_cast<quint32>(a), entries[a]);
+					}
+				}
+			});
+			image.reset();
+			decoded.clear();
+		}
+
+		// Forget the binary save, along with any entries not decoded from it yet, and the indices built over them.
+		void release_image() noexcept {
+			image.reset();
+			decoded.clear();
+			drop_indices();
+		}
+
+		// Drop the index by identity, the full-text index, and the facets, which are built again when next needed.
+		void drop_indices() const noexcept {
+			identityIndex.clear();
+			indexed = false;
+			searchIndex.clear();
+			searchIndexed = false;
+			facets.clear();
+			facetsIndexed = false;
+		}
+
+		// Build the facets if they have not been built yet.
+		void build_facets() const {
+			if(!facetsIndexed) {
+				materialize_all();
+				facets.build(*this);
+				facetsIndexed = true;
+			}
+		}
+
+		// Build the index of the entries by identity if it has not been built yet.
+		void build_index() const {
+			if(indexed) {
+				return;
+			}
+
+			materialize_all();
+			identityIndex.clear();
+			identityIndex.reserve(order.size());
+			for(auto const slot: order) {
+				identityIndex.emplace(identity_hash(entries[slot]), slot);
+			}
+			indexed = true;
+		}
+
+		// Remove the entry in the given slot from the index by identity.
+		void unindex(EntryVector::size_type const slot) {
+			auto [first, last] = identityIndex.equal_range(identity_hash(entries[slot]));
+			for(; first != last; ++first) {
+				if(first->second == slot) {
+					identityIndex.erase(first);
+
+					return;
+				}
+			}
+		}
+
+		// Build the index of each slot if it has not been built yet.
+		void build_positions() const {
+			if(!positioned) {
+				positions.resize(entries.size());
+				for(EntryVector::size_type a = 0; a < order.size(); ++a) {
+					positions[order[a]] = a;
+				}
+				positioned = true;
+			}
+		}
+
+		// Returns the index of the entry in the given slot.
+		EntryVector::size_type position_of(EntryVector::size_type const slot) const {
+			build_positions();
+			return positions[slot];
+		}
+
+		// Update the index of each slot for the entries from the given index onwards after they shifted.
+		void reposition(EntryVector::size_type const from) {
+			if(positioned) {
+				positions.resize(entries.size());
+				for(auto a = from; a < order.size(); ++a) {
+					positions[order[a]] = a;
+				}
+			}
+		}
+
+		// Put the given entry, which must have an ID not used yet, into an empty slot or a new one if there is none,
+		// and index it by its ID; returns its slot.
+		EntryVector::size_type place(Entry &&entry) {
+			EntryVector::size_type slot;
+			if(freeSlots.empty()) {
+				slot = entries.size();
+				entries.push_back(std::move(entry));
+				if(image) {
+					decoded.push_back(true);
+				}
+			}
+			else {
+				slot = freeSlots.back();
+				freeSlots.pop_back();
+				entries[slot] = std::move(entry);
+			}
+			slotsById.emplace(entries[slot].get_id(), slot);
+
+			return slot;
+		}
+
+		// Start the list over with the entries in the slots in order, as just loaded, indexing them by ID;
+		// each keeps the ID it was saved with unless it has none or another entry has it, in which case it gets a new one.
+		// The given ID is the lowest to give to new entries.
+		void index_ids(EntryId const next) {
+			order.resize(entries.size());
+			std::iota(order.begin(), order.end(), EntryVector::size_type(0));
+			freeSlots.clear();
+			positioned = false;
+			nextId = std::max(next, EntryId(1));
+			for(auto const &a: entries) {
+				nextId = std::max(nextId, a.get_id() + 1);
+			}
+
+			slotsById.clear();
+			slotsById.reserve(entries.size());
+			for(EntryVector::size_type a = 0; a < entries.size(); ++a) {
+				if(!entries[a].get_id() || !slotsById.emplace(entries[a].get_id(), a).second) {
+					entries[a].set_id(nextId++);
+					slotsById.emplace(entries[a].get_id(), a);
+				}
+			}
+		}
+
+		// Give the entries in the slots in order, as just loaded, the given saved IDs, and index them by ID again;
+		// any entry without one gets a new one.
+		void assign_ids(std::vector<EntryId> const &ids) {
+			for(EntryVector::size_type a = 0; a < entries.size(); ++a) {
+				entries[a].set_id(a < ids.size() ? ids[a] : 0);
+			}
+			index_ids(1);
+		}
 
 		public:
+		// The iterator over the entries in list order (const).
+		using const_iterator = EntryIterator<Entry const>;
+
 		// Default constructor that initializes the collator.
-		Entries(): name(u"Entries"_qs), entries(), collator() {
-			collator.setCaseSensitivity(Qt::CaseSensitivity::CaseInsensitive);
-			collator.setIgnorePunctuation(false);
-			collator.setNumericMode(true);
+		Entries():
+				name(u"Entries"_qs), entries(), order(), freeSlots(), slotsById(), nextId(1), positions(),
+				positioned(false), image(), decoded(), identityIndex(), indexed(false), searchIndex(), searchIndexed(false),
+				facets(), facetsIndexed(false), collator(make_collator()), threadCount(0), stringBuffers() {}
+
+		// Copy constructor that copies the entries but not the indices over them, which are built again when needed.
+		// It copies every entry, so it takes time and memory in proportion to their number; only the field values,
+		// which are implicitly shared, are not copied. Any entries not decoded from a binary save yet are decoded by the
+		// copy on its own.
+		Entries(Entries const &other):
+				name(other.name), entries(other.entries), order(other.order), freeSlots(other.freeSlots),
+				slotsById(other.slotsById), nextId(other.nextId), positions(), positioned(false), image(other.image),
+				decoded(other.decoded), identityIndex(), indexed(false), searchIndex(), searchIndexed(false), facets(),
+				facetsIndexed(false), collator(other.collator), threadCount(other.threadCount),
+				stringBuffers(other.stringBuffers) {
+			for(auto &a: entries) {
+				a.set_collator(collator);
+			}
+		}
+
+		Entries &operator=(Entries const &) = delete;
+
+		// Getter for the name of this list of entries.
+		QString const &get_name() const noexcept {
+			return name;
+		}
+
+		// The name of the member that holds the IDs of the entries in JSON, in list order; they are kept apart from the
+		// entries, so that no field of an entry can take the name.
+		static QString const &get_ids_name() {
+			static QString const idsName(u"_Entry IDs"_qs);
+			return idsName;
 		}
 
-		// Overload of the subscript operator that accesses the underlying vector object.
-		auto &operator[](EntryVector::size_type const index) {
-			return entries[index];
+		// Overload of the subscript operator that accesses the underlying vector object (const);
+		// use the functions below to edit entries.
+		auto const &operator[](EntryVector::size_type const index) const {
+			EntryVector::size_type const slot = order[index];
+			materialize(slot);
+			return entries[slot];
 		}
 
-		// Wrapper for entries.begin() for easy iteration.
-		auto begin() {
-			return entries.begin();
+		// Edit the entry at the given index by calling the given function with it, then drop the indices over the
+		// entries, which the edit may have made stale; the functions below keep them up to date instead.
+		template<typename Edit>
+		void edit_entry(EntryVector::size_type const index, Edit &&edit) {
+			EntryVector::size_type const slot = order[index];
+			materialize(slot);
+			edit(entries[slot]);
+			drop_indices();
 		}
 
-		// Wrapper for entries.end() for easy iteration.
-		auto end() {
-			return entries.end();
+		// Returns the entry at the given index (const).
+		auto const &at(EntryVector::size_type const index) const {
+			EntryVector::size_type const slot = order.at(index);
+			materialize(slot);
+			return entries[slot];
+		}
+
+		// Returns an iterator to the first entry for easy iteration (const).
+		const_iterator begin() const {
+			materialize_all();
+			return const_iterator(entries.data(), order.cbegin());
+		}
+
+		// Returns an iterator past the last entry for easy iteration (const).
+		const_iterator end() const {
+			materialize_all();
+			return const_iterator(entries.data(), order.cend());
 		}
 
 		// Get the number of entries in the list.
 		auto size() const noexcept {
-			return entries.size();
+			return order.size();
+		}
+
+		// Returns the ID of the entry at the given index, which is known without decoding the entry.
+		EntryId get_id(EntryVector::size_type const index) const {
+			return entries[order.at(index)].get_id();
+		}
+
+		// Returns the ID that the next new entry will get.
+		EntryId get_next_id() const noexcept {
+			return nextId;
+		}
+
+		// Make sure that no entry gets an ID lower than the given one from now on,
+		// e.g. so that the IDs of entries deleted before the list was saved are not given out again.
+		void reserve_ids(EntryId const next) noexcept {
+			nextId = std::max(nextId, next);
+		}
+
+		// Set the number of threads to use for sorting (0 for one per hardware thread, 1 for no extra threads).
+		void set_thread_count(unsigned const count) noexcept {
+			threadCount = count;
 		}
 
 		// Create a new entry.
@@ -58,68 +403,415 @@ namespace omm {
 			return Entry(collator);
 		}
 
-		// Add the given entry to the list of entries; the given entry contains no data after this.
+		// Add the given entry to the end of the list of entries; the given entry contains no data after this.
+		// The entry keeps its ID if it has one that was never given out, e.g. when replaying the journal,
+		// and gets a new one otherwise, so that no ID is ever given to two entries.
 		void add_entry(Entry &&entry) {
-			entries.push_back(std::move(entry));
+			// The entry may come from another list of entries, whose string buffers this list does not keep.
+			entry.set_collator(collator);
+			entry.own_strings();
+			if(EntryId const id = entry.get_id(); id >= nextId) {
+				nextId = id + 1;
+			}
+			else {
+				entry.set_id(nextId++);
+			}
+			EntryVector::size_type const index = order.size();
+			if(searchIndexed) {
+				searchIndex.insert(index, entry);
+			}
+			if(facetsIndexed) {
+				facets.insert(index, entry);
+			}
+			std::size_t const hash = indexed ? identity_hash(entry) : 0;
+			EntryVector::size_type const slot = place(std::move(entry));
+			order.push_back(slot);
+			if(indexed) {
+				identityIndex.emplace(hash, slot);
+			}
+			reposition(index);
+		}
+
+		// Returns the index of the given entry, or the number of entries if it is not in the list.
+		// Entries are looked up by the hash of their identity, so this takes constant time on average.
+		EntryVector::size_type find(Entry const &entry) const {
+			build_index();
+			auto found = order.size();
+			auto [first, last] = identityIndex.equal_range(identity_hash(entry));
+			for(; first != last; ++first) {
+				if(entries[first->second] == entry) {
+					found = std::min(found, position_of(first->second));
+				}
+			}
+
+			return found;
+		}
+
+		// Returns the index of the entry with the given ID, or the number of entries if it is not in the list.
+		EntryVector::size_type find_id(EntryId const id) const {
+			auto const si = slotsById.find(id);
+			return si == slotsById.cend() ? order.size() : position_of(si->second);
+		}
+
+		// Returns true if an entry with the same title, type, author, and year as the given entry is in the list.
+		bool contains(Entry const &entry) const {
+			return find(entry) != order.size();
+		}
+
+		// Set the given field of the entry at the given index, keeping the indices up to date.
+		void set_field(EntryVector::size_type const index, Field const field, QString value) {
+			EntryVector::size_type const slot = order[index];
+			materialize(slot);
+			bool const reindex = indexed && is_identity_field(field);
+			if(reindex) {
+				unindex(slot);
+			}
+			int const facet = facetsIndexed ? Facets::facet_of(field) : -1;
+			QString const oldFacetValue = facet >= 0 ? Facets::value(entries[slot], static_cast<Facet>(facet)) : QString();
+			entries[slot][field] = std::move(value);
+			if(facet >= 0) {
+				facets.update(index, static_cast<Facet>(facet), oldFacetValue, entries[slot]);
+			}
+			if(reindex) {
+				identityIndex.emplace(identity_hash(entries[slot]), slot);
+			}
+			if(searchIndexed && std::find(searchFields.cbegin(), searchFields.cend(), field) != searchFields.cend()) {
+				searchIndex.update(index, entries[slot]);
+			}
+		}
+
+		// Returns the indices of up to the given number of entries that contain the given text in their title,
+		// original title, franchise/series, author, or notes, ignoring case, best match first.
+		std::vector<EntryVector::size_type> search(QString const &query, std::size_t const limit) const {
+			if(!searchIndexed) {
+				materialize_all();
+				searchIndex.build(*this);
+				searchIndexed = true;
+			}
+
+			return searchIndex.search(query, limit);
+		}
+
+		// Returns the indices of the entries that match the given filter, in order.
+		std::vector<EntryVector::size_type> filter(FacetFilter const &filter) const {
+			build_facets();
+			return facets.match(filter).positions();
+		}
+
+		// Returns the number of entries with each value of the given facet among the entries that match the given filter.
+		std::map<QString, int> facet_counts(Facet const facet, FacetFilter const &filter) const {
+			build_facets();
+			return facets.counts(facet, facets.match(filter));
+		}
+
+		// Add the given chapter to the specified list of chapters of the entry at the given index.
+		void add_chapter(EntryVector::size_type const index, QString const &chapter, ChapterList const cl) {
+			EntryVector::size_type const slot = order[index];
+			materialize(slot);
+			entries[slot].add_chapter(chapter, cl);
+		}
+
+		// Add all the chapters in the given text to the specified list of chapters of the entry at the given index at once
+		// (see Chapters::import()).
+		void import_chapters(EntryVector::size_type const index, QStringView const text, ChapterList const cl) {
+			EntryVector::size_type const slot = order[index];
+			materialize(slot);
+			entries[slot].import_chapters(text, cl);
+		}
+
+		// Remove the given chapter from the specified list of chapters of the entry at the given index.
+		void delete_chapter(EntryVector::size_type const index, QString const &chapter, ChapterList const cl) {
+			EntryVector::size_type const slot = order[index];
+			materialize(slot);
+			entries[slot].delete_chapter(chapter, cl);
+		}
+
+		// Duplicate the entry at the given index and insert the duplicate, with a new ID, right after it.
+		void duplicate_entry(EntryVector::size_type const index) {
+			materialize(order[index]);
+			Entry duplicate(entries[order[index]]);
+			duplicate.set_id(nextId++);
+			if(searchIndexed) {
+				searchIndex.insert(index + 1, duplicate);
+			}
+			if(facetsIndexed) {
+				facets.insert(index + 1, duplicate);
+			}
+			std::size_t const hash = indexed ? identity_hash(duplicate) : 0;
+			EntryVector::size_type const slot = place(std::move(duplicate));
+			order.insert(order.cbegin() + static_cast<EntryVector::difference_type>(index) + 1, slot);
+			if(indexed) {
+				identityIndex.emplace(hash, slot);
+			}
+			reposition(index + 1);
 		}
 
 		// Duplicate the given entry and insert the duplicate right after the given entry.
-		void duplicate_entry(Entry const &entry) {
-			auto const entryIt = std::find(entries.cbegin(), entries.cend(), entry);
-			if(entryIt != entries.cend()) {
-				entries.insert(std::next(entryIt), entry);
+		// Returns true if the given entry was found.
+		bool duplicate_entry(Entry const &entry) {
+			if(auto const index = find(entry); index != order.size()) {
+				duplicate_entry(index);
+
+				return true;
 			}
+
+			return false;
+		}
+
+		// Deletes the entry at the given index from the list of entries.
+		// The entry leaves its slot empty for the next added entry, so no other entry is moved.
+		void delete_entry(EntryVector::size_type const index) {
+			EntryVector::size_type const slot = order[index];
+			if(indexed) {
+				unindex(slot);
+			}
+			if(searchIndexed) {
+				searchIndex.erase(index);
+			}
+			if(facetsIndexed) {
+				facets.erase(index);
+			}
+			slotsById.erase(entries[slot].get_id());
+			entries[slot] = Entry(collator);
+			if(image) {
+				// There is nothing left to decode into the empty slot.
+				decoded[slot] = true;
+			}
+			freeSlots.push_back(slot);
+			order.erase(order.cbegin() + static_cast<EntryVector::difference_type>(index));
+			reposition(index);
 		}
 
 		// Deletes the given entry from the list of entries.
-		void delete_entry(Entry &entry) {
-			auto const entryIt = std::find(entries.cbegin(), entries.cend(), entry);
-			if(entryIt != entries.cend()) {
-				entries.erase(entryIt);
+		// Returns true if the given entry was found.
+		bool delete_entry(Entry const &entry) {
+			if(auto const index = find(entry); index != order.size()) {
+				delete_entry(index);
+
+				return true;
 			}
+
+			return false;
 		}
 
-		// Sort the list of entries according to the specifications.
+		// Work out how to sort the list of entries according to the specifications, without changing it yet.
 		// Specifically, group the entries by franchise/series, order the entries within each franchise/series by
 		// story order, title, then type, order the groups of franchise/series by franchise/series name, and then
 		// have the rest of the entries come after ordered by title, then type, and finally,
 		// organize the liked and loved chapters of each entry.
-		void sort() {
+		// Returns the previous index of the entry to put at each index, to pass to apply_sort(); the given progress, if
+		// any, is advanced by two for each entry, and cancelling it returns an empty list.
+		// Only the sort keys and chapters of the entries are changed, so the list may be read on another thread
+		// meanwhile (e.g. to show it) as long as it is not edited and its entries were all decoded (see from_binary()).
+		std::vector<EntryVector::size_type> prepare_sort(Progress *const progress = nullptr) {
+			OMM_PROFILE_SCOPE(Sort, order.size());
+			materialize_all();
+			if(progress) {
+				progress->set_total(static_cast<qint64>(order.size()) * 2);
+			}
+
+			// Large lists are sorted using several threads; the result is the same as when using one.
+			unsigned const threads = resolve_thread_count(threadCount, order.size());
+
+			// Run the given function on each of the entries from begin to end, advancing the progress every so many
+			// entries; returns false if it was cancelled.
+			auto const for_each_entry = [&](EntryVector::size_type const begin, EntryVector::size_type const end,
+												auto &&function) {
+				for(auto a = begin; a < end;) {
+					auto const stop = std::min(end, a + static_cast<EntryVector::size_type>(progressInterval));
+					auto const start = a;
+					for(; a < stop; ++a) {
+						function(entries[order[a]]);
+					}
+					if(progress && !progress->advance(static_cast<qint64>(stop - start))) {
+						return false;
+					}
+				}
+				return true;
+			};
+
+			// Compute the collation sort keys of any entries that changed since the last sort,
+			// so that the comparisons below do not need to run the collator.
+			// QCollator is not thread-safe, so each extra thread uses its own collator with the same settings.
+			parallel_chunks(order.size(), threads, [&](EntryVector::size_type const begin, EntryVector::size_type const end) {
+				if(threads == 1) {
+					for_each_entry(begin, end, [](Entry &a) {
+						a.prepare_sort_keys();
+					});
+				}
+				else {
+					QCollator const local(make_collator());
+					for_each_entry(begin, end, [&](Entry &a) {
+						a.prepare_sort_keys(local);
+					});
+				}
+			});
+			if(progress && progress->is_cancelled()) {
+				return {};
+			}
+
+			// Sort the indices of the entries rather than the entries themselves.
+			std::vector<EntryVector::size_type> sorted(order.size());
+			std::iota(sorted.begin(), sorted.end(), EntryVector::size_type(0));
+			auto const entry = [&](EntryVector::size_type const i) -> Entry const & {
+				return entries[order[i]];
+			};
+
 			// Partition the list of entries into those that are members of a franchise or series, and those that are not.
-			QString const fskey(u"Franchise/Series"_qs), fsokey(u"Franchise/Series Order"_qs);
-			auto partIter = std::partition(entries.begin(), entries.end(), [&](Entry &entry) {
-				return !entry[fskey].isEmpty();
+			// Both the partition and the sorts are stable so that the result does not depend on the number of threads.
+			auto const fskey = Field::FranchiseSeries;
+			auto partIter = std::stable_partition(sorted.begin(), sorted.end(), [&](EntryVector::size_type const i) {
+				return !entry(i).at(fskey).isEmpty();
 			});
 
 			// Sort the entries that are members of a franchise or series separately first.
-			std::sort(entries.begin(), partIter, [&](Entry &l, Entry &r) {
-				return l[fskey] == r[fskey] ? l[fsokey] == r[fsokey] ? l < r : l[fsokey].toInt() < r[fsokey].toInt() :
-												collator(l[fskey], r[fskey]);
-			});
+			parallel_stable_sort(sorted.begin(), partIter, threads,
+					[&](EntryVector::size_type const li, EntryVector::size_type const ri) {
+						Entry const &l = entry(li), &r = entry(ri);
+						return l.at(fskey) == r.at(fskey) ?
+										l.get_order() == r.get_order() ? l < r : l.get_order() < r.get_order() :
+										l.compare(r, fskey) < 0;
+					});
 
 			// Sort the rest of the entries after.
-			std::sort(partIter, entries.end());
+			parallel_stable_sort(partIter, sorted.end(), threads,
+					[&](EntryVector::size_type const li, EntryVector::size_type const ri) {
+						return entry(li) < entry(ri);
+					});
 
 			// Organize the liked and loved chapters of each entry.
-			for(auto &entry: entries) {
-				entry.organize_chapters();
+			parallel_chunks(order.size(), threads, [&](EntryVector::size_type const begin, EntryVector::size_type const end) {
+				for_each_entry(begin, end, [](Entry &a) {
+					a.organize_chapters();
+				});
+			});
+			if(progress && progress->is_cancelled()) {
+				return {};
+			}
+
+			return sorted;
+		}
+
+		// Put the entries in the order worked out by prepare_sort(), given as the previous index of the entry to put at
+		// each index; this takes time in proportion to the number of entries.
+		void apply_sort(std::vector<EntryVector::size_type> const &sorted) {
+			// Reorder the slots rather than the entries, unless the entries were already sorted;
+			// the index by identity and the index by ID refer to slots, so they stay as they are.
+			if(sorted.size() != order.size() || std::is_sorted(sorted.cbegin(), sorted.cend())) {
+				return;
+			}
+
+			std::vector<EntryVector::size_type> reordered(order.size());
+			for(EntryVector::size_type a = 0; a < sorted.size(); ++a) {
+				reordered[a] = order[sorted[a]];
+			}
+			order.swap(reordered);
+			positioned = false;
+
+			if(searchIndexed) {
+				searchIndex.permute(sorted);
+			}
+			if(facetsIndexed) {
+				facets.permute(sorted);
 			}
 		}
 
+		// Sort the list of entries (see prepare_sort()).
+		// Returns the previous index of the entry now at each index.
+		std::vector<EntryVector::size_type> sort() {
+			auto sorted = prepare_sort();
+			apply_sort(sorted);
+			return sorted;
+		}
+
+		// Move the entries into list order and drop the empty slots of deleted entries, unless they already are;
+		// returns true if any entry was moved.
+		// This keeps the slots from growing past the largest the list has been and makes iterating over the list
+		// sequential again.
+		bool compact() {
+			bool inOrder = freeSlots.empty() && entries.size() == order.size();
+			for(EntryVector::size_type a = 0; inOrder && a < order.size(); ++a) {
+				inOrder = order[a] == a;
+			}
+			if(inOrder) {
+				return false;
+			}
+
+			materialize_all();
+			EntryVector compacted;
+			compacted.reserve(order.size());
+			for(auto const slot: order) {
+				compacted.push_back(std::move(entries[slot]));
+			}
+			entries.swap(compacted);
+
+			// Point the index by identity and the index by ID at the new slots, which are now the indices.
+			build_positions();
+			for(auto &a: identityIndex) {
+				a.second = positions[a.second];
+			}
+			for(auto &a: slotsById) {
+				a.second = positions[a.second];
+			}
+			std::iota(order.begin(), order.end(), EntryVector::size_type(0));
+			freeSlots.clear();
+			positions.resize(order.size());
+			std::iota(positions.begin(), positions.end(), EntryVector::size_type(0));
+
+			return true;
+		}
+
 		// Serialize this list of entries in JSON format.
 		void to_json(QJsonObject &json) const {
+			materialize_all();
 			QJsonArray entriesArray;
-			for(auto const &a: entries) {
+			for(auto const slot: order) {
 				QJsonObject entryObject;
-				a.to_json(entryObject);
+				entries[slot].to_json(entryObject);
 				entriesArray.append(entryObject);
 			}
 			json[name] = entriesArray;
+
+			QJsonArray idsArray;
+			for(auto const slot: order) {
+				idsArray.append(static_cast<qint64>(entries[slot].get_id()));
+			}
+			json[get_ids_name()] = idsArray;
+		}
+
+		// Serialize this list of entries as a member of the current object of the given writer,
+		// writing each entry as it goes and advancing the given progress, if any, by one for each.
+		// Returns false if the progress was cancelled, leaving the output incomplete.
+		bool to_writer(JsonWriter &writer, Progress *const progress = nullptr) const {
+			materialize_all();
+			writer.begin_array(name);
+			for(auto const slot: order) {
+				writer.next_element();
+				entries[slot].to_writer(writer);
+				if(progress && !progress->advance()) {
+					return false;
+				}
+			}
+			writer.end_array();
+
+			return true;
+		}
+
+		// Serialize the IDs of the entries, in list order, as a member of the current object of the given writer;
+		// the entries themselves are written without them by to_writer().
+		void ids_to_writer(JsonWriter &writer) const {
+			writer.begin_array(get_ids_name());
+			for(auto const slot: order) {
+				writer.element(static_cast<qint64>(entries[slot].get_id()));
+			}
+			writer.end_array();
 		}
 
 		// Reconstruct this list of entries from JSON data.
 		void from_json(const QJsonObject &json) {
+			release_image();
 			entries.clear();
+			stringBuffers.clear();
 			QJsonArray entriesArray = json[name].toArray();
 			entries.reserve(entriesArray.size());
 			for(auto const &a: entriesArray) {
@@ -127,6 +819,98 @@ namespace omm {
 				entry.from_json(a.toObject());
 				entries.push_back(std::move(entry));
 			}
+
+			std::vector<EntryId> ids;
+			for(auto const &a: json[get_ids_name()].toArray()) {
+				ids.push_back(static_cast<EntryId>(std::max(a.toInteger(), qint64(0))));
+			}
+			assign_ids(ids);
+		}
+
+		// Reconstruct this list of entries from the array that the given reader is at,
+		// building each entry directly from the input and advancing the given progress, if any, by one for each.
+		// The field values are views of a few large buffers shared by the entries (see StringArena), which this list
+		// keeps until its entries are replaced; an entry edited or added to another list gets values of its own.
+		// Returns false if the input is invalid or the progress was cancelled.
+		bool from_reader(JsonReader &reader, Progress *const progress = nullptr) {
+			release_image();
+			entries.clear();
+			stringBuffers.clear();
+			index_ids(1);
+			if(reader.peek_type() != JsonType::Array) {
+				return reader.skip_value();
+			}
+
+			reader.enter_array();
+			StringArena arena;
+			while(reader.next_element()) {
+				Entry entry(collator);
+				if(reader.peek_type() == JsonType::Object) {
+					entry.from_reader(reader, arena);
+				}
+				else {
+					reader.skip_value();
+				}
+				entries.push_back(std::move(entry));
+				if(progress && !progress->advance()) {
+					stringBuffers = arena.take_buffers();
+					index_ids(1);
+					return false;
+				}
+			}
+			stringBuffers = arena.take_buffers();
+			index_ids(1);
+
+			return !reader.has_error();
+		}
+
+		// Read the IDs of the entries from the array that the given reader is at, and give them to the entries just
+		// read by from_reader(), which come before them in a save; returns false if the input is invalid.
+		bool ids_from_reader(JsonReader &reader) {
+			if(reader.peek_type() != JsonType::Array) {
+				return reader.skip_value();
+			}
+
+			std::vector<EntryId> ids;
+			ids.reserve(entries.size());
+			reader.enter_array();
+			while(reader.next_element()) {
+				qint64 value = 0;
+				if(reader.peek_type() == JsonType::Number) {
+					reader.read_integer(value);
+				}
+				else {
+					reader.skip_value();
+				}
+				ids.push_back(value > 0 ? static_cast<EntryId>(value) : 0);
+			}
+			assign_ids(ids);
+
+			return !reader.has_error();
+		}
+
+		// Add every entry to the given builder of a binary save.
+		void to_binary(BinaryBuilder &builder) const {
+			materialize_all();
+			for(auto const slot: order) {
+				builder.add_entry(entries[slot]);
+			}
+		}
+
+		// Reconstruct this list of entries from the given binary save without decoding any entry yet;
+		// each entry is decoded the first time it is accessed, but its ID is read right away.
+		void from_binary(std::shared_ptr<BinaryImage const> _image) {
+			release_image();
+			entries.clear();
+			stringBuffers.clear();
+			quint32 const count = _image->entry_count();
+			entries.reserve(count);
+			for(quint32 a = 0; a < count; ++a) {
+				entries.emplace_back(collator).set_id(_image->entry_id(a));
+			}
+			index_ids(_image->next_entry_id());
+			decoded.assign(count, false);
+			image = std::move(_image);
 		}
 	};
 } // namespace omm
@@ -1,37 +1,41 @@
 #include "entry.hpp"
 
-#include <QtDebug>
+#include <QHash>
 
 namespace omm {
+	// The fields used to identify and order entries.
+	static constexpr std::array<Field, 4> identityFields{Field::Title, Field::Type, Field::Author, Field::Year};
+
 	bool operator<(Entry const &l, Entry const &r) {
-		StringVector const keys{u"Title"_qs, u"Type"_qs, u"Author"_qs, u"Year"_qs};
-		try {
-			for(auto const &key: keys) {
-				if(l.at(key) != r.at(key)) {
-					return l.less(l.at(key), r.at(key));
-				}
+		for(auto const field: identityFields) {
+			if(l.at(field) != r.at(field)) {
+				return l.compare(r, field) < 0;
 			}
 		}
-		catch(std::exception const &e) {
-			qDebug() << u"This exception should not occur (Entry less than):"_qs << e.what();
-		}
 
 		return false;
 	}
 
 	bool operator==(Entry const &l, Entry const &r) {
-		StringVector const keys{u"Title"_qs, u"Type"_qs, u"Author"_qs, u"Year"_qs};
-		try {
-			for(auto const &key: keys) {
-				if(l.at(key) != r.at(key)) {
-					return false;
-				}
+		for(auto const field: identityFields) {
+			if(l.at(field) != r.at(field)) {
+				return false;
 			}
 		}
-		catch(std::exception const &e) {
-			qDebug() << u"This exception should not occur (Entry equal to):"_qs << e.what();
-		}
 
 		return true;
 	}
+
+	bool is_identity_field(Field const field) noexcept {
+		return std::find(identityFields.cbegin(), identityFields.cend(), field) != identityFields.cend();
+	}
+
+	std::size_t identity_hash(Entry const &entry) {
+		std::size_t hash = 0;
+		for(auto const field: identityFields) {
+			hash ^= qHash(entry.at(field)) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+		}
+
+		return hash;
+	}
 } // namespace omm
@@ -1,18 +1,32 @@
 #pragma once
 
 #include <QCollator>
+#include <QCollatorSortKey>
 #include <QJsonObject>
 #include <QString>
-#include <map>
+#include <QStringList>
+#include <QStringView>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
 #include "chapters.hpp"
+#include "field.hpp"
 
 // Exclusive namespace for the OMM.
 namespace omm {
-	// Alias.
+	// Aliases.
 	using StringVector = std::vector<QString>;
+	using CustomFieldVector = std::vector<std::pair<FieldKey, QString>>;
+	// The stable ID of an entry, which it keeps across edits, sorts, and saves; 0 until the entry is added to a list.
+	using EntryId = quint64;
+
+	// The fields that affect sorting, whose collation sort keys are cached by each entry.
+	inline constexpr std::array<Field, 5> sortFields{
+			Field::FranchiseSeries, Field::Title, Field::Type, Field::Author, Field::Year};
 
 	// Enum for choosing which list of chapters to target.
 	enum class ChapterList : int { liked, loved };
@@ -20,14 +34,52 @@ namespace omm {
 	// The class that manages an entry.
 	class Entry {
 		private:
-		// The map containing most of the elements of this entry.
-		std::map<QString, QString> details;
+		// The stable ID of this entry, given by the list of entries it is added to.
+		EntryId id;
+		// The values of the standard fields of this entry, indexed by Field.
+		std::array<QString, standardFieldCount> fields;
+		// The values of any custom fields of this entry, sorted by key.
+		CustomFieldVector customFields;
 		// The vector containing the list of liked chapters.
 		Chapters likedChapters;
 		// The vector containing the list of loved chapters.
 		Chapters lovedChapters;
-		// Pointer to the QCollator to use for comparison.
-		QCollator const &collator;
+		// The cached collation sort keys of the fields in sortFields, in the same order; empty until prepared.
+		std::array<std::optional<QCollatorSortKey>, sortFields.size()> sortKeys;
+		// The cached numeric value of the franchise/series order.
+		std::optional<int> order;
+		// Pointer to the QCollator to use for comparison (a pointer rather than a reference so that entries can be assigned).
+		QCollator const *collator;
+
+		// Returns the position of the given field in sortFields, or -1 if it does not affect sorting.
+		static int sort_index(Field const field) noexcept {
+			auto const fi = std::find(sortFields.cbegin(), sortFields.cend(), field);
+			return fi == sortFields.cend() ? -1 : static_cast<int>(fi - sortFields.cbegin());
+		}
+
+		// Drop the cached sort key of the given field, since it may be about to change.
+		void invalidate(Field const field) noexcept {
+			if(field == Field::FranchiseSeriesOrder) {
+				order.reset();
+			}
+			else if(int const si = sort_index(field); si >= 0) {
+				sortKeys[static_cast<std::size_t>(si)].reset();
+			}
+		}
+
+		// Returns the position of the given custom field, or where it would be inserted.
+		CustomFieldVector::iterator find_custom(FieldKey const key) {
+			return std::lower_bound(customFields.begin(), customFields.end(), key, [](auto const &field, FieldKey const k) {
+				return field.first < k;
+			});
+		}
+
+		// Returns the position of the given custom field, or where it would be inserted (const).
+		CustomFieldVector::const_iterator find_custom(FieldKey const key) const {
+			return std::lower_bound(customFields.cbegin(), customFields.cend(), key, [](auto const &field, FieldKey const k) {
+				return field.first < k;
+			});
+		}
 
 		public:
 		// Forbid constructing an entry without a collator.
@@ -35,27 +87,74 @@ namespace omm {
 
 		// Constructor that initializes the necessary elements to their default states, and sets the collator.
 		Entry(QCollator const &_collator):
-				details(), likedChapters(u"Liked Chapters"_qs), lovedChapters(u"Loved Chapters"_qs), collator(_collator) {
-			// Fill the details map with the default elements.
-			for(auto const &key: {u"Title"_qs, u"Original Title"_qs, u"Franchise/Series"_qs, u"Franchise/Series Order"_qs,
-						u"Author"_qs, u"Year"_qs, u"Type"_qs, u"Language"_qs, u"Rating"_qs, u"Progress"_qs, u"Notes"_qs}) {
-				details[key].clear();
+				id(0), fields(), customFields(), likedChapters(u"Liked Chapters"_qs), lovedChapters(u"Loved Chapters"_qs),
+				sortKeys(), order(), collator(&_collator) {}
+
+		// Getter for the stable ID of this entry.
+		EntryId get_id() const noexcept {
+			return id;
+		}
+
+		// Setter for the stable ID of this entry; only the list of entries that holds it should give it one.
+		void set_id(EntryId const _id) noexcept {
+			id = _id;
+		}
+
+		// Use the given collator from now on, e.g. after the entry was copied into another list of entries.
+		void set_collator(QCollator const &_collator) noexcept {
+			collator = &_collator;
+		}
+
+		// Access the given standard field; this drops its cached sort key, so use at() when only reading.
+		QString &operator[](Field const field) {
+			invalidate(field);
+			return fields[static_cast<std::size_t>(field)];
+		}
+
+		// Access the given standard field (const).
+		QString const &at(Field const field) const {
+			return fields[static_cast<std::size_t>(field)];
+		}
+
+		// Access the field with the given key, creating it if it is a custom field that this entry does not have yet.
+		QString &operator[](FieldKey const key) {
+			if(FieldKeys::is_standard(key)) {
+				return (*this)[static_cast<Field>(key)];
 			}
+
+			auto fi = find_custom(key);
+			if(fi == customFields.end() || fi->first != key) {
+				fi = customFields.emplace(fi, key, QString());
+			}
+			return fi->second;
 		}
 
-		// Wrapper for accessing the underlying map object.
-		auto &operator[](QString const &key) {
-			return details[key];
+		// Access the field with the given key (const); throws std::out_of_range if this entry does not have it.
+		QString const &at(FieldKey const key) const {
+			if(FieldKeys::is_standard(key)) {
+				return fields[static_cast<std::size_t>(key)];
+			}
+
+			auto const fi = find_custom(key);
+			if(fi == customFields.cend() || fi->first != key) {
+				throw std::out_of_range("omm::Entry::at: no such field");
+			}
+			return fi->second;
 		}
 
-		// Wrapper for accessing the underlying map object (const).
-		auto const &at(QString const &key) const {
-			return details.at(key);
+		// Access the field with the given name, creating it if it is a custom field that this entry does not have yet.
+		QString &operator[](QString const &key) {
+			return (*this)[FieldKeys::intern(key)];
 		}
 
-		// Wrapper for the size of the underlying map object.
+		// Access the field with the given name (const); throws std::out_of_range if this entry does not have it.
+		QString const &at(QString const &key) const {
+			return at(FieldKeys::find(key));
+		}
+
+		// The number of fields of this entry.
 		auto size() const noexcept {
-			return details.size();
+			return fields.size() + customFields.size();
 		}
 
 		// Add the given chapter to the specified list of chapters.
@@ -63,6 +162,21 @@ namespace omm {
 			cl == ChapterList::liked ? likedChapters.add(chapter) : lovedChapters.add(chapter);
 		}
 
+		// Add all the given chapters to the specified list of chapters at once.
+		void add_chapters(ChapterVector &&chapters, ChapterList cl) {
+			cl == ChapterList::liked ? likedChapters.add(std::move(chapters)) : lovedChapters.add(std::move(chapters));
+		}
+
+		// Add all the given chapters in string form to the specified list of chapters at once.
+		void add_chapters(QStringList const &chapters, ChapterList cl) {
+			cl == ChapterList::liked ? likedChapters.add(chapters) : lovedChapters.add(chapters);
+		}
+
+		// Add all the chapters in the given text (e.g. "1~50, 52, 60.1~60.9") to the specified list of chapters at once.
+		void import_chapters(QStringView const text, ChapterList cl) {
+			cl == ChapterList::liked ? likedChapters.import(text) : lovedChapters.import(text);
+		}
+
 		// Remove the given chapter from the specified list of chapters.
 		void delete_chapter(QString const &chapter, ChapterList cl) {
 			cl == ChapterList::liked ? likedChapters.remove(chapter) : lovedChapters.remove(chapter);
@@ -84,31 +198,172 @@ namespace omm {
 			return lovedChapters;
 		}
 
+		// Getter for the liked chapters (const).
+		Chapters const &get_likedChapters() const noexcept {
+			return likedChapters;
+		}
+
+		// Getter for the loved chapters (const).
+		Chapters const &get_lovedChapters() const noexcept {
+			return lovedChapters;
+		}
+
+		// Getter for the custom fields, sorted by key.
+		CustomFieldVector const &get_customFields() const noexcept {
+			return customFields;
+		}
+
 		// Comparison function for QStrings used when comparing entries.
 		bool less(QString const &l, QString const &r) const {
-			return collator(l, r);
+			return (*collator)(l, r);
+		}
+
+		// Compute the sort keys of the fields that affect sorting that are not cached yet.
+		void prepare_sort_keys() {
+			prepare_sort_keys(*collator);
+		}
+
+		// Compute the sort keys of the fields that affect sorting that are not cached yet using the given collator,
+		// which must have the same settings as the collator of this entry (for use from other threads).
+		void prepare_sort_keys(QCollator const &c) {
+			for(std::size_t a = 0; a < sortFields.size(); ++a) {
+				if(!sortKeys[a]) {
+					sortKeys[a].emplace(c.sortKey(at(sortFields[a])));
+				}
+			}
+			if(!order) {
+				order = at(Field::FranchiseSeriesOrder).toInt();
+			}
+		}
+
+		// Returns the numeric value of the franchise/series order.
+		int get_order() const {
+			return order ? *order : at(Field::FranchiseSeriesOrder).toInt();
+		}
+
+		// Compares the given field of this entry and the given entry using the collator;
+		// uses the cached sort keys when both entries have them.
+		int compare(Entry const &other, Field const field) const {
+			if(int const si = sort_index(field); si >= 0) {
+				auto const &lk = sortKeys[static_cast<std::size_t>(si)], &rk = other.sortKeys[static_cast<std::size_t>(si)];
+				if(lk && rk) {
+					return lk->compare(*rk);
+				}
+			}
+
+			return collator->compare(at(field), other.at(field));
 		}
 
 		// Serialize this entry in JSON format.
 		void to_json(QJsonObject &json) const {
-			for(auto const &a: details) {
-				json[a.first] = a.second;
+			for(std::size_t a = 0; a < fields.size(); ++a) {
+				json[FieldKeys::name(static_cast<Field>(a))] = fields[a];
+			}
+			for(auto const &a: customFields) {
+				json[FieldKeys::name(a.first)] = a.second;
 			}
 			likedChapters.to_json(json);
 			lovedChapters.to_json(json);
 		}
 
+		// Serialize this entry as the current value of the given writer.
+		void to_writer(JsonWriter &writer) const {
+			// Write the members in the same order as QJsonObject, which keeps them sorted by key;
+			// each member is identified by its field key, or by -1 and -2 for the liked and loved chapters.
+			std::vector<std::pair<QString, FieldKey>> members;
+			members.reserve(fields.size() + customFields.size() + 2);
+			for(std::size_t a = 0; a < fields.size(); ++a) {
+				members.emplace_back(FieldKeys::name(static_cast<Field>(a)), static_cast<FieldKey>(a));
+			}
+			for(auto const &a: customFields) {
+				members.emplace_back(FieldKeys::name(a.first), a.first);
+			}
+			members.emplace_back(likedChapters.get_name(), -1);
+			members.emplace_back(lovedChapters.get_name(), -2);
+			std::sort(members.begin(), members.end());
+
+			writer.begin_object();
+			for(auto const &[key, fk]: members) {
+				if(fk == -1 || fk == -2) {
+					writer.key(key);
+					(fk == -1 ? likedChapters : lovedChapters).to_writer(writer);
+				}
+				else {
+					writer.member(key, at(fk));
+				}
+			}
+			writer.end_object();
+		}
+
 		// Reconstruct this entry from JSON data.
+		// The ID is not part of the entry in JSON, where every member is a field or a list of chapters; the list of
+		// entries saves the IDs of its entries apart from them (see Entries::to_json()).
 		void from_json(const QJsonObject &json) {
-			details.clear();
+			id = 0;
+			for(auto &field: fields) {
+				field.clear();
+			}
+			customFields.clear();
+			for(auto &key: sortKeys) {
+				key.reset();
+			}
+			order.reset();
 			for(auto ci = json.constBegin(); ci != json.constEnd(); ++ci) {
 				if(ci.value().isString()) {
-					details[ci.key()] = ci.value().toString();
+					(*this)[ci.key()] = ci.value().toString();
 				}
 			}
 			likedChapters.from_json(json);
 			lovedChapters.from_json(json);
 		}
+
+		// Give each value of this entry memory of its own, so that it no longer depends on the buffers of the
+		// StringArena that it was loaded into; the values are unchanged, so their sort keys stay valid.
+		void own_strings() {
+			for(auto &field: fields) {
+				own(field);
+			}
+			for(auto &[key, value]: customFields) {
+				own(value);
+			}
+			likedChapters.own_strings();
+			lovedChapters.own_strings();
+		}
+
+		// Reconstruct this entry from the object that the given reader is at, storing its values in the given arena;
+		// they are views of its buffers (see StringArena), which the caller must keep for as long as the entry.
+		bool from_reader(JsonReader &reader, StringArena &arena) {
+			id = 0;
+			for(auto &field: fields) {
+				field.clear();
+			}
+			customFields.clear();
+			for(auto &key: sortKeys) {
+				key.reset();
+			}
+			order.reset();
+
+			if(!reader.enter_object()) {
+				return false;
+			}
+			QString key;
+			while(reader.next_key(key)) {
+				if(key == likedChapters.get_name()) {
+					likedChapters.from_reader(reader, arena);
+				}
+				else if(key == lovedChapters.get_name()) {
+					lovedChapters.from_reader(reader, arena);
+				}
+				else if(reader.peek_type() == JsonType::String) {
+					reader.read_string((*this)[key], arena);
+				}
+				else {
+					reader.skip_value();
+				}
+			}
+
+			return !reader.has_error();
+		}
 	};
 
 	// Uses title, type, author, and year for comparison.
@@ -116,4 +371,10 @@ namespace omm {
 
 	// Uses title, type, author, and year for comparison.
 	bool operator==(Entry const &l, Entry const &r);
+
+	// Returns true if the given field is one of title, type, author, and year, which identify an entry.
+	bool is_identity_field(Field const field) noexcept;
+
+	// Hash of title, type, author, and year; entries that compare equal have the same hash.
+	std::size_t identity_hash(Entry const &entry);
 } // namespace omm
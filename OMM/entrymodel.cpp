@@ -0,0 +1,295 @@
+#include "entrymodel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+
+namespace omm {
+	// Returns true if the given filter accepts every entry.
+	static bool is_empty(FacetFilter const &filter) {
+		return std::all_of(filter.cbegin(), filter.cend(), [](StringVector const &values) {
+			return values.empty();
+		});
+	}
+
+	EntryModel::EntryModel(Save &_save, QObject *parent):
+			QAbstractTableModel(parent), save(&_save), rows(), query(), facetFilter() {}
+
+	EntryVector::size_type EntryModel::entry_index(int const row) const {
+		return rows ? (*rows)[static_cast<std::size_t>(row)] : static_cast<EntryVector::size_type>(row);
+	}
+
+	void EntryModel::apply_filter() {
+		if(query.isEmpty() && is_empty(facetFilter)) {
+			rows.reset();
+
+			return;
+		}
+
+		if(query.isEmpty()) {
+			rows = save->filter(facetFilter);
+
+			return;
+		}
+
+		// Keep the order of the search results, dropping those that the filter does not accept.
+		rows = save->search(query, save->size());
+		if(!is_empty(facetFilter)) {
+			auto const accepted = save->filter(facetFilter);
+			rows->erase(std::remove_if(rows->begin(), rows->end(),
+								[&](EntryVector::size_type const index) {
+									return !std::binary_search(accepted.cbegin(), accepted.cend(), index);
+								}),
+					rows->end());
+		}
+	}
+
+	bool EntryModel::matches(EntryVector::size_type const index) const {
+		if(!is_empty(facetFilter)) {
+			auto const accepted = save->filter(facetFilter);
+			if(!std::binary_search(accepted.cbegin(), accepted.cend(), index)) {
+				return false;
+			}
+		}
+		if(!query.isEmpty()) {
+			auto const found = save->search(query, save->size());
+			return std::find(found.cbegin(), found.cend(), index) != found.cend();
+		}
+
+		return true;
+	}
+
+	void EntryModel::shift_rows(EntryVector::size_type const from, std::ptrdiff_t const by) {
+		for(auto &index: *rows) {
+			if(index >= from) {
+				index = static_cast<EntryVector::size_type>(static_cast<std::ptrdiff_t>(index) + by);
+			}
+		}
+	}
+
+	void EntryModel::refilter() {
+		beginResetModel();
+		apply_filter();
+		endResetModel();
+	}
+
+	int EntryModel::rowCount(QModelIndex const &parent) const {
+		if(parent.isValid()) {
+			return 0;
+		}
+
+		return static_cast<int>(rows ? rows->size() : save->size());
+	}
+
+	int EntryModel::columnCount(QModelIndex const &parent) const {
+		return parent.isValid() ? 0 : static_cast<int>(standardFieldCount);
+	}
+
+	QVariant EntryModel::data(QModelIndex const &index, int const role) const {
+		if(!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+			return QVariant();
+		}
+
+		return save->get_entry(entry_index(index.row())).at(static_cast<Field>(index.column()));
+	}
+
+	QVariant EntryModel::headerData(int const section, Qt::Orientation const orientation, int const role) const {
+		if(role != Qt::DisplayRole) {
+			return QVariant();
+		}
+
+		if(orientation == Qt::Horizontal) {
+			return FieldKeys::name(static_cast<Field>(section));
+		}
+
+		return section + 1;
+	}
+
+	Qt::ItemFlags EntryModel::flags(QModelIndex const &index) const {
+		if(!index.isValid()) {
+			return Qt::NoItemFlags;
+		}
+
+		return QAbstractTableModel::flags(index) | Qt::ItemIsEditable;
+	}
+
+	bool EntryModel::setData(QModelIndex const &index, QVariant const &value, int const role) {
+		if(!index.isValid() || role != Qt::EditRole) {
+			return false;
+		}
+
+		auto const field = static_cast<Field>(index.column());
+		QString text = value.toString();
+		if(save->get_entry(entry_index(index.row())).at(field) == text) {
+			return true;
+		}
+
+		save->set_field(entry_index(index.row()), field, std::move(text));
+		emit edited();
+		if(rows && !matches(entry_index(index.row()))) {
+			// The edit made the entry stop matching the search or filter, so its row goes; the other rows stay as they
+			// are until the search or filter changes.
+			beginRemoveRows(QModelIndex(), index.row(), index.row());
+			rows->erase(rows->cbegin() + index.row());
+			endRemoveRows();
+		}
+		else {
+			emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
+		}
+
+		return true;
+	}
+
+	bool EntryModel::removeRows(int const row, int const count, QModelIndex const &parent) {
+		if(parent.isValid() || row < 0 || count <= 0 || row + count > rowCount()) {
+			return false;
+		}
+
+		if(rows) {
+			// Delete from the highest index down so that the other indices stay valid, then move the indices of the
+			// rows left down past the deleted entries.
+			std::vector<EntryVector::size_type> indices(rows->cbegin() + row, rows->cbegin() + row + count);
+			std::sort(indices.begin(), indices.end(), std::greater<>());
+			beginRemoveRows(QModelIndex(), row, row + count - 1);
+			for(auto const index: indices) {
+				save->delete_entry(index);
+			}
+			rows->erase(rows->cbegin() + row, rows->cbegin() + row + count);
+			for(auto const index: indices) {
+				shift_rows(index + 1, -1);
+			}
+			endRemoveRows();
+			emit edited();
+
+			return true;
+		}
+
+		beginRemoveRows(QModelIndex(), row, row + count - 1);
+		for(int a = row + count - 1; a >= row; --a) {
+			save->delete_entry(static_cast<EntryVector::size_type>(a));
+		}
+		endRemoveRows();
+		emit edited();
+
+		return true;
+	}
+
+	void EntryModel::sort(int, Qt::SortOrder) {
+		emit sort_requested();
+	}
+
+	void EntryModel::apply_sort(std::vector<EntryVector::size_type> const &order) {
+		if(order.size() != save->size()) {
+			return;
+		}
+
+		emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+		save->apply_refresh(order);
+
+		// The persistent indices (e.g. the selection) and the previous index of the entry in the row of each.
+		QModelIndexList const from = persistentIndexList();
+		std::vector<EntryVector::size_type> fromEntries;
+		fromEntries.reserve(static_cast<std::size_t>(from.size()));
+		for(auto const &index: from) {
+			fromEntries.push_back(entry_index(index.row()));
+		}
+
+		// The new index of each entry by its previous index.
+		std::vector<EntryVector::size_type> position(order.size());
+		for(std::size_t a = 0; a < order.size(); ++a) {
+			position[order[a]] = a;
+		}
+
+		// The row of each entry by its new index, with the rows shown for a search or filter following their entries;
+		// the search results keep their order, but the filter results are kept in list order.
+		std::vector<int> rowOf(order.size(), -1);
+		if(rows) {
+			for(auto &index: *rows) {
+				index = position[index];
+			}
+			if(query.isEmpty()) {
+				std::sort(rows->begin(), rows->end());
+			}
+			for(std::size_t a = 0; a < rows->size(); ++a) {
+				rowOf[(*rows)[a]] = static_cast<int>(a);
+			}
+		}
+		else {
+			std::iota(rowOf.begin(), rowOf.end(), 0);
+		}
+
+		// Move the persistent indices along with their entries.
+		QModelIndexList to;
+		to.reserve(from.size());
+		for(qsizetype a = 0; a < from.size(); ++a) {
+			to.append(this->index(rowOf[position[fromEntries[static_cast<std::size_t>(a)]]], from[a].column()));
+		}
+		changePersistentIndexList(from, to);
+		emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+	}
+
+	void EntryModel::add_entry(Entry &&entry) {
+		if(rows) {
+			// The entry is added after the last entry, so it only gets a row, after the last one, if it matches.
+			save->add_entry(std::move(entry));
+			if(auto const index = save->size() - 1; matches(index)) {
+				int const row = rowCount();
+				beginInsertRows(QModelIndex(), row, row);
+				rows->push_back(index);
+				endInsertRows();
+			}
+			emit edited();
+
+			return;
+		}
+
+		int const row = rowCount();
+		beginInsertRows(QModelIndex(), row, row);
+		save->add_entry(std::move(entry));
+		endInsertRows();
+		emit edited();
+	}
+
+	void EntryModel::duplicate_entry(int const row) {
+		if(rows) {
+			// The duplicate matches like the entry and comes right after it, so it gets the row right after its row,
+			// and the entries after it move up by one.
+			auto const index = entry_index(row);
+			beginInsertRows(QModelIndex(), row + 1, row + 1);
+			save->duplicate_entry(index);
+			shift_rows(index + 1, 1);
+			rows->insert(rows->cbegin() + row + 1, index + 1);
+			endInsertRows();
+			emit edited();
+
+			return;
+		}
+
+		beginInsertRows(QModelIndex(), row + 1, row + 1);
+		save->duplicate_entry(static_cast<EntryVector::size_type>(row));
+		endInsertRows();
+		emit edited();
+	}
+
+	void EntryModel::set_search(QString const &text) {
+		query = text;
+		refilter();
+	}
+
+	void EntryModel::set_filter(FacetFilter const &filter) {
+		facetFilter = filter;
+		refilter();
+	}
+
+	void EntryModel::reload() {
+		refilter();
+	}
+
+	void EntryModel::set_save(Save &_save) {
+		beginResetModel();
+		save = &_save;
+		apply_filter();
+		endResetModel();
+	}
+} // namespace omm
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "save.hpp"
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The table model that shows the entries of a save with one row per entry and one column per standard field.
+	// Each cell is read from the entry only when the view asks for it, and the edits made through the model are
+	// applied to the save and signalled row by row, so a view only ever touches the rows that are visible.
+	class EntryModel: public QAbstractTableModel {
+		Q_OBJECT
+
+		private:
+		// The save whose entries are shown.
+		Save *save;
+		// The entries shown, by index in the save, while a search or filter is applied; edits keep the rows of the
+		// entries that still match where they are, so the rows only follow the search order again once it changes.
+		std::optional<std::vector<EntryVector::size_type>> rows;
+		// The text to search for, if any.
+		QString query;
+		// The values to filter by.
+		FacetFilter facetFilter;
+
+		// Returns the index in the save of the entry in the given row.
+		EntryVector::size_type entry_index(int const row) const;
+		// Work out which entries to show for the current search and filter.
+		void apply_filter();
+		// Returns true if the entry at the given index in the save matches the current search and filter.
+		bool matches(EntryVector::size_type index) const;
+		// Move the indices of the rows shown for a search or filter from the given index onwards by the given amount,
+		// after entries were inserted or deleted before them.
+		void shift_rows(EntryVector::size_type from, std::ptrdiff_t by);
+		// Apply the search and filter again, e.g. after they changed.
+		void refilter();
+
+		public:
+		// Constructor that takes the save whose entries to show.
+		explicit EntryModel(Save &_save, QObject *parent = nullptr);
+
+		int rowCount(QModelIndex const &parent = QModelIndex()) const override;
+		int columnCount(QModelIndex const &parent = QModelIndex()) const override;
+		QVariant data(QModelIndex const &index, int role = Qt::DisplayRole) const override;
+		QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+		Qt::ItemFlags flags(QModelIndex const &index) const override;
+		bool setData(QModelIndex const &index, QVariant const &value, int role = Qt::EditRole) override;
+		bool removeRows(int row, int count, QModelIndex const &parent = QModelIndex()) override;
+		// Ask for the entries to be sorted by emitting sort_requested(), since sorting takes time in proportion to the
+		// number of entries; the entries have a single order, so the column and order are ignored.
+		void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+		// Put the entries in the order worked out by Save::prepare_refresh(), e.g. on another thread, moving the rows
+		// and the persistent indices along with their entries.
+		// Sorting changes no entry, so it is not an edit and does not call for a save.
+		void apply_sort(std::vector<EntryVector::size_type> const &order);
+
+		// Add the given entry to the save after the last row.
+		void add_entry(Entry &&entry);
+		// Duplicate the entry in the given row, inserting the duplicate right after it.
+		void duplicate_entry(int row);
+		// Show only the entries that contain the given text, best match first (all entries if it is empty).
+		void set_search(QString const &text);
+		// Show only the entries that match the given filter (all entries if it is empty).
+		void set_filter(FacetFilter const &filter);
+		// Reload every row, e.g. after the save was loaded.
+		void reload();
+		// Show the entries of the given save instead, e.g. one loaded on another thread, keeping the search and filter.
+		void set_save(Save &_save);
+
+		signals:
+		// Emitted after each edit made to the save through the model.
+		void edited();
+		// Emitted when the view asks for the entries to be sorted (see sort()).
+		void sort_requested();
+	};
+} // namespace omm
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <QString>
+#include <QtAlgorithms>
+#include <array>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "entry.hpp"
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The class that holds one bit per entry, packed into 64-bit words.
+	class Bitmap {
+		private:
+		// The bits, lowest position first.
+		std::vector<quint64> words;
+		// The number of bits.
+		std::size_t count;
+
+		// Clear any bits past the end in the last word.
+		void trim() noexcept {
+			if(count % 64) {
+				words.back() &= (quint64(1) << (count % 64)) - 1;
+			}
+		}
+
+		public:
+		// Constructor that makes a bitmap of the given size with every bit set to the given value.
+		explicit Bitmap(std::size_t const size = 0, bool const value = false):
+				words((size + 63) / 64, value ? ~quint64(0) : 0), count(size) {
+			trim();
+		}
+
+		// Get the number of bits.
+		std::size_t size() const noexcept {
+			return count;
+		}
+
+		// Returns the bit at the given position.
+		bool test(std::size_t const position) const noexcept {
+			return words[position / 64] >> (position % 64) & 1;
+		}
+
+		// Set the bit at the given position to the given value.
+		void set(std::size_t const position, bool const value = true) noexcept {
+			quint64 const mask = quint64(1) << (position % 64);
+			if(value) {
+				words[position / 64] |= mask;
+			}
+			else {
+				words[position / 64] &= ~mask;
+			}
+		}
+
+		// Insert a bit with the given value at the given position, moving the bits after it up by one.
+		void insert(std::size_t const position, bool const value) {
+			if(count % 64 == 0) {
+				words.push_back(0);
+			}
+			++count;
+			std::size_t const first = position / 64;
+			for(std::size_t a = words.size() - 1; a > first; --a) {
+				words[a] = words[a] << 1 | words[a - 1] >> 63;
+			}
+			quint64 const low = (quint64(1) << (position % 64)) - 1;
+			words[first] = (words[first] & low) | (words[first] & ~low) << 1;
+			set(position, value);
+		}
+
+		// Remove the bit at the given position, moving the bits after it down by one.
+		void erase(std::size_t const position) {
+			std::size_t const first = position / 64;
+			quint64 const low = (quint64(1) << (position % 64)) - 1;
+			words[first] = (words[first] & low) | (words[first] >> 1 & ~low);
+			for(std::size_t a = first; a + 1 < words.size(); ++a) {
+				words[a] |= words[a + 1] << 63;
+				words[a + 1] >>= 1;
+			}
+			--count;
+			if(count % 64 == 0) {
+				words.pop_back();
+			}
+		}
+
+		// Get the number of set bits.
+		std::size_t popcount() const noexcept {
+			std::size_t total = 0;
+			for(auto const word: words) {
+				total += static_cast<std::size_t>(qPopulationCount(word));
+			}
+			return total;
+		}
+
+		// Get the number of bits set in both this bitmap and the given one, without building their intersection.
+		std::size_t popcount(Bitmap const &other) const noexcept {
+			std::size_t total = 0;
+			for(std::size_t a = 0; a < words.size() && a < other.words.size(); ++a) {
+				total += static_cast<std::size_t>(qPopulationCount(words[a] & other.words[a]));
+			}
+			return total;
+		}
+
+		// Keep only the bits that are also set in the given bitmap.
+		Bitmap &operator&=(Bitmap const &other) noexcept {
+			for(std::size_t a = 0; a < words.size(); ++a) {
+				words[a] &= a < other.words.size() ? other.words[a] : 0;
+			}
+			return *this;
+		}
+
+		// Also set the bits that are set in the given bitmap.
+		Bitmap &operator|=(Bitmap const &other) noexcept {
+			for(std::size_t a = 0; a < words.size() && a < other.words.size(); ++a) {
+				words[a] |= other.words[a];
+			}
+			return *this;
+		}
+
+		// Returns the positions of the set bits in ascending order.
+		std::vector<std::size_t> positions() const {
+			std::vector<std::size_t> result;
+			result.reserve(popcount());
+			for(std::size_t a = 0; a < words.size(); ++a) {
+				for(quint64 word = words[a]; word; word &= word - 1) {
+					std::size_t bit = 0;
+					while(!(word >> bit & 1)) {
+						++bit;
+					}
+					result.push_back(a * 64 + bit);
+				}
+			}
+			return result;
+		}
+	};
+
+	// Enum for the fields that entries can be filtered by.
+	enum class Facet : int { Type = 0, Language, Progress, Rating, Year };
+
+	// The number of facets.
+	inline constexpr std::size_t facetCount = 5;
+
+	// The values accepted for each facet, indexed by Facet; an entry matches if, for every facet with any values,
+	// its value is one of them (so values of one facet are ORed, and facets are ANDed).
+	using FacetFilter = std::array<StringVector, facetCount>;
+
+	// The class that keeps, for each value of each facet, a bitmap of the entries that have that value.
+	class Facets {
+		private:
+		// The bitmaps of each value of each facet, indexed by Facet.
+		std::array<std::map<QString, Bitmap>, facetCount> bitmaps;
+		// The number of entries.
+		std::size_t count;
+
+		// Set the bit of the given value of the given facet at the given position, adding the value if needed.
+		void set(Facet const facet, QString const &value, std::size_t const position) {
+			auto [bi, inserted] = bitmaps[static_cast<std::size_t>(facet)].try_emplace(value, count);
+			bi->second.set(position);
+		}
+
+		public:
+		Facets(): bitmaps(), count(0) {}
+
+		// Returns the value of the given facet for the given entry, grouped the same way as the counts of a save.
+		static QString value(Entry const &entry, Facet const facet) {
+			switch(facet) {
+				case Facet::Type:
+					return entry.at(Field::Type).isEmpty() ? u"Unspecified"_qs : entry.at(Field::Type);
+				case Facet::Language:
+					return entry.at(Field::Language).isEmpty() ? u"Unspecified"_qs : entry.at(Field::Language);
+				case Facet::Progress:
+					if(entry.at(Field::Progress).isEmpty()) {
+						return u"Not Started"_qs;
+					}
+					return entry.at(Field::Progress) == u"Finished"_qs ? u"Finished"_qs : u"In Progress"_qs;
+				case Facet::Rating:
+					return entry.at(Field::Rating).isEmpty() ? u"Unspecified"_qs : entry.at(Field::Rating);
+				case Facet::Year:
+					return entry.at(Field::Year).isEmpty() ? u"Unspecified"_qs : entry.at(Field::Year);
+			}
+			return QString();
+		}
+
+		// Returns the facet that the given field affects, or -1 if it affects none.
+		static int facet_of(Field const field) noexcept {
+			switch(field) {
+				case Field::Type:
+					return static_cast<int>(Facet::Type);
+				case Field::Language:
+					return static_cast<int>(Facet::Language);
+				case Field::Progress:
+					return static_cast<int>(Facet::Progress);
+				case Field::Rating:
+					return static_cast<int>(Facet::Rating);
+				case Field::Year:
+					return static_cast<int>(Facet::Year);
+				default:
+					return -1;
+			}
+		}
+
+		// Remove every entry.
+		void clear() noexcept {
+			for(auto &facet: bitmaps) {
+				facet.clear();
+			}
+			count = 0;
+		}
+
+		// Build the bitmaps of the given list of entries from scratch; any list with size() and at() will do.
+		template<typename List>
+		void build(List const &entries) {
+			clear();
+			count = entries.size();
+			for(std::size_t a = 0; a < entries.size(); ++a) {
+				for(std::size_t f = 0; f < facetCount; ++f) {
+					set(static_cast<Facet>(f), value(entries.at(a), static_cast<Facet>(f)), a);
+				}
+			}
+		}
+
+		// Add the given entry, which is inserted into the list at the given position.
+		void insert(std::size_t const position, Entry const &entry) {
+			for(auto &facet: bitmaps) {
+				for(auto &a: facet) {
+					a.second.insert(position, false);
+				}
+			}
+			++count;
+			for(std::size_t f = 0; f < facetCount; ++f) {
+				set(static_cast<Facet>(f), value(entry, static_cast<Facet>(f)), position);
+			}
+		}
+
+		// Remove the entry at the given position, which is removed from the list.
+		void erase(std::size_t const position) {
+			for(auto &facet: bitmaps) {
+				for(auto &a: facet) {
+					a.second.erase(position);
+				}
+			}
+			--count;
+		}
+
+		// Move the entry at the given position from the given old value of the given facet to its value in the entry.
+		void update(std::size_t const position, Facet const facet, QString const &oldValue, Entry const &entry) {
+			auto &values = bitmaps[static_cast<std::size_t>(facet)];
+			if(auto const bi = values.find(oldValue); bi != values.end()) {
+				bi->second.set(position, false);
+			}
+			set(facet, value(entry, facet), position);
+		}
+
+		// Follow the entries to their new positions, where the entry now at each position was at order[position].
+		void permute(std::vector<std::size_t> const &order) {
+			for(auto &facet: bitmaps) {
+				for(auto &a: facet) {
+					Bitmap permuted(count);
+					for(std::size_t b = 0; b < order.size(); ++b) {
+						if(a.second.test(order[b])) {
+							permuted.set(b);
+						}
+					}
+					a.second = std::move(permuted);
+				}
+			}
+		}
+
+		// Returns the bitmap of the entries that match the given filter.
+		Bitmap match(FacetFilter const &filter) const {
+			Bitmap result(count, true);
+			for(std::size_t f = 0; f < facetCount; ++f) {
+				if(filter[f].empty()) {
+					continue;
+				}
+
+				Bitmap any(count);
+				for(auto const &value: filter[f]) {
+					if(auto const bi = bitmaps[f].find(value); bi != bitmaps[f].cend()) {
+						any |= bi->second;
+					}
+				}
+				result &= any;
+			}
+			return result;
+		}
+
+		// Returns the number of entries with each value of the given facet among the given entries.
+		std::map<QString, int> counts(Facet const facet, Bitmap const &subset) const {
+			std::map<QString, int> result;
+			for(auto const &a: bitmaps[static_cast<std::size_t>(facet)]) {
+				if(auto const n = a.second.popcount(subset); n > 0) {
+					result.emplace(a.first, static_cast<int>(n));
+				}
+			}
+			return result;
+		}
+
+		// Returns the values of the given facet that any entry has.
+		StringVector values(Facet const facet) const {
+			StringVector result;
+			for(auto const &a: bitmaps[static_cast<std::size_t>(facet)]) {
+				if(a.second.popcount() > 0) {
+					result.push_back(a.first);
+				}
+			}
+			return result;
+		}
+	};
+} // namespace omm
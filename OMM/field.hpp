@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// Enum for the standard fields that every entry has.
+	enum class Field : int {
+		Title = 0,
+		OriginalTitle,
+		FranchiseSeries,
+		FranchiseSeriesOrder,
+		Author,
+		Year,
+		Type,
+		Language,
+		Rating,
+		Progress,
+		Notes
+	};
+
+	// The number of standard fields.
+	inline constexpr std::size_t standardFieldCount = 11;
+
+	// The interned form of a field name; standard fields use the value of their Field enum, and custom fields follow.
+	using FieldKey = int;
+
+	// The class that interns the names of fields so that entries can refer to them by number.
+	class FieldKeys {
+		private:
+		// The table of custom field names shared by all entries.
+		struct Table {
+			// Guards the table, since entries may be loaded or edited from several threads.
+			std::mutex mutex;
+			// The map from the name of each custom field to its key.
+			std::map<QString, FieldKey> keys;
+			// The names of the custom fields in key order (a deque so that references stay valid as it grows).
+			std::deque<QString> names;
+		};
+
+		static Table &table() {
+			static Table t;
+			return t;
+		}
+
+		public:
+		// Returns the name of the given standard field.
+		static QString const &name(Field const field) {
+			static std::array<QString, standardFieldCount> const names{u"Title"_qs, u"Original Title"_qs,
+					u"Franchise/Series"_qs, u"Franchise/Series Order"_qs, u"Author"_qs, u"Year"_qs, u"Type"_qs,
+					u"Language"_qs, u"Rating"_qs, u"Progress"_qs, u"Notes"_qs};
+			return names[static_cast<std::size_t>(field)];
+		}
+
+		// Returns the name of the field with the given key.
+		static QString name(FieldKey const key) {
+			if(is_standard(key)) {
+				return name(static_cast<Field>(key));
+			}
+
+			Table &t = table();
+			std::lock_guard const lock(t.mutex);
+			return t.names[static_cast<std::size_t>(key) - standardFieldCount];
+		}
+
+		// Returns true if the given key belongs to a standard field.
+		static bool is_standard(FieldKey const key) noexcept {
+			return key >= 0 && static_cast<std::size_t>(key) < standardFieldCount;
+		}
+
+		// Returns the key of the given standard field name, or -1 if it is not one.
+		static FieldKey find_standard(QStringView const name) {
+			for(std::size_t a = 0; a < standardFieldCount; ++a) {
+				if(FieldKeys::name(static_cast<Field>(a)) == name) {
+					return static_cast<FieldKey>(a);
+				}
+			}
+
+			return -1;
+		}
+
+		// Returns the key of the field with the given name, or -1 if no entry has used it yet.
+		static FieldKey find(QString const &name) {
+			if(FieldKey const key = find_standard(name); key >= 0) {
+				return key;
+			}
+
+			Table &t = table();
+			std::lock_guard const lock(t.mutex);
+			auto const ki = t.keys.find(name);
+			return ki == t.keys.cend() ? -1 : ki->second;
+		}
+
+		// Returns the key of the field with the given name, registering it as a custom field if needed.
+		static FieldKey intern(QString const &name) {
+			if(FieldKey const key = find_standard(name); key >= 0) {
+				return key;
+			}
+
+			Table &t = table();
+			std::lock_guard const lock(t.mutex);
+			auto [ki, inserted] = t.keys.try_emplace(name, static_cast<FieldKey>(standardFieldCount + t.names.size()));
+			if(inserted) {
+				t.names.push_back(name);
+			}
+			return ki->second;
+		}
+	};
+} // namespace omm
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <QHash>
+#include <QSaveFile>
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <cstddef>
+#include <random>
+
+#include "entries.hpp"
+#include "jsonwriter.hpp"
+#include "save.hpp"
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The class that generates synthetic libraries for measuring the OMM, with titles in several scripts,
+	// franchises, and reading histories from a few chapters to hundreds of ranges, some numbered volume.chapter.
+	// The same seed always gives the same library, on any platform.
+	class Generator {
+		private:
+		// The source of randomness; its output is fully specified by the standard, unlike the distributions.
+		std::mt19937_64 rng;
+		// The number of times each title was generated, so that repeated titles become sequels.
+		QHash<QString, int> titles;
+
+		// Returns a number from 0 up to but not including the given bound.
+		std::size_t below(std::size_t const bound) {
+			return static_cast<std::size_t>(rng() % bound);
+		}
+
+		// Returns true with the given chance in percent.
+		bool chance(std::size_t const percent) {
+			return below(100) < percent;
+		}
+
+		// Returns a random element of the given list.
+		template<typename T, std::size_t size>
+		T const &pick(std::array<T, size> const &list) {
+			return list[below(size)];
+		}
+
+		// Returns a random index below the given bound, favouring the low ones the way popularity does.
+		std::size_t popular(std::size_t const bound) {
+			std::size_t const a = below(bound);
+			return a * below(bound) / bound;
+		}
+
+		// Returns the given number of characters picked from the given pool of characters.
+		QString characters(QStringView const pool, std::size_t const count) {
+			QString s;
+			s.reserve(static_cast<qsizetype>(count));
+			for(std::size_t a = 0; a < count; ++a) {
+				s.append(pool[static_cast<qsizetype>(below(static_cast<std::size_t>(pool.size())))]);
+			}
+			return s;
+		}
+
+		// Returns a title made of English words.
+		QString english_title() {
+			static std::array<QString, 40> const words{u"Sword"_qs, u"Dragon"_qs, u"Academy"_qs, u"Reincarnated"_qs,
+					u"Villainess"_qs, u"Tower"_qs, u"Star"_qs, u"Moon"_qs, u"Demon"_qs, u"King"_qs, u"Princess"_qs,
+					u"Shadow"_qs, u"Tale"_qs, u"Chronicle"_qs, u"Magic"_qs, u"Hero"_qs, u"Last"_qs, u"Lord"_qs,
+					u"Legend"_qs, u"Dungeon"_qs, u"Summer"_qs, u"Blue"_qs, u"Spring"_qs, u"Garden"_qs, u"Witch"_qs,
+					u"Saint"_qs, u"Knight"_qs, u"Cat"_qs, u"Café"_qs, u"Love"_qs, u"Night"_qs, u"Sky"_qs, u"Ocean"_qs,
+					u"Rebirth"_qs, u"Game"_qs, u"Level"_qs, u"Hunter"_qs, u"Empire"_qs, u"Flower"_qs, u"Snow"_qs};
+			static std::array<QString, 4> const joins{u" of the "_qs, u" and the "_qs, u" in "_qs, u" "_qs};
+
+			QString title = chance(30) ? u"The "_qs : QString();
+			title += pick(words);
+			for(std::size_t a = below(4); a > 0; --a) {
+				title += pick(joins) + pick(words);
+			}
+			return title;
+		}
+
+		// Returns a title in Japanese, Korean, or Chinese.
+		QString cjk_title() {
+			switch(below(3)) {
+				case 0:
+					return characters(u"あいうえおかきくけこさしすせそたちつてとなにのはひふまみむめもやゆよらりるれろわん"
+									  u"剣竜魔王姫勇者星月夜空花雪学園転生悪役令嬢迷宮騎士聖女恋猫物語",
+							3 + below(10));
+				case 1: {
+					// Hangul syllables, in words of two to four.
+					QString title;
+					for(std::size_t a = 1 + below(3); a > 0; --a) {
+						if(!title.isEmpty()) {
+							title.append(u' ');
+						}
+						for(std::size_t b = 2 + below(3); b > 0; --b) {
+							title.append(QChar(static_cast<char16_t>(0xAC00 + below(11172))));
+						}
+					}
+					return title;
+				}
+				default:
+					return characters(u"天下剑仙魔道神龙帝王侠客江湖风云传说之少年修真世界重生都市", 2 + below(8));
+			}
+		}
+
+		// Returns a title that was not generated before; a repeated title becomes a sequel (e.g. "Star Tale 2").
+		QString unique(QString title) {
+			int &count = titles[title];
+			if(count++) {
+				title += u" "_qs + QString::number(count);
+			}
+			return title;
+		}
+
+		// Returns a reading history in string form: ascending ranges of chapters with gaps in between,
+		// from a single chapter to hundreds of ranges, numbered volume.chapter if nested.
+		QStringList history(std::size_t const ranges, bool const nested) {
+			QStringList chapters;
+			chapters.reserve(static_cast<qsizetype>(ranges));
+			std::size_t volume = 1 + below(3), cursor = below(5);
+			for(std::size_t a = 0; a < ranges; ++a) {
+				cursor += 1 + below(20);
+				std::size_t const length = chance(40) ? 0 : below(50);
+				if(nested && chance(20)) {
+					++volume;
+					cursor = 1 + below(3);
+				}
+				QString const prefix = nested ? QString::number(volume) + u'.' : QString();
+				QString chapter = prefix + QString::number(cursor);
+				if(length) {
+					cursor += length;
+					chapter += u"~"_qs + prefix + QString::number(cursor);
+				}
+				chapters.append(chapter);
+			}
+			return chapters;
+		}
+
+		// Returns the number of ranges in a reading history: often none, usually a few, and now and then hundreds.
+		std::size_t history_length() {
+			std::size_t const a = below(100);
+			return a < 35 ? 0 : a < 80 ? 1 + below(3) : a < 97 ? 4 + below(17) : 21 + below(280);
+		}
+
+		public:
+		// Constructor that takes the seed that decides the library.
+		explicit Generator(quint64 const seed = 1): rng(seed), titles() {}
+
+		// Returns a single chapter or range of chapters in string form, as found in reading histories.
+		QString chapter() {
+			return history(1, chance(15)).front();
+		}
+
+		// Generate the given number of entries and add them to the given list of entries.
+		void generate(Entries &entries, std::size_t const count) {
+			static std::array<QString, 6> const types{
+					u"Manga"_qs, u"Manhwa"_qs, u"Manhua"_qs, u"Novel"_qs, u"Web Novel"_qs, u"Anime"_qs};
+			static std::array<QString, 4> const languages{u"Japanese"_qs, u"Korean"_qs, u"Chinese"_qs, u"English"_qs};
+
+			std::size_t const franchises = count / 8 + 1, authors = count / 20 + 1;
+			for(std::size_t a = 0; a < count; ++a) {
+				Entry entry = entries.create_entry();
+				std::size_t const script = below(100);
+				if(script < 60) {
+					entry[Field::Title] = unique(english_title());
+					if(chance(50)) {
+						entry[Field::OriginalTitle] = cjk_title();
+					}
+				}
+				else {
+					entry[Field::Title] = unique(cjk_title());
+				}
+				if(chance(30)) {
+					entry[Field::FranchiseSeries] = u"Franchise "_qs + QString::number(popular(franchises));
+					entry[Field::FranchiseSeriesOrder] = QString::number(1 + below(12));
+				}
+				entry[Field::Author] = u"Author "_qs + QString::number(popular(authors));
+				entry[Field::Year] = QString::number(2025 - popular(56));
+				entry[Field::Type] = pick(types);
+				entry[Field::Language] = script < 60 ? pick(languages) : languages[below(3)];
+				if(chance(85)) {
+					entry[Field::Rating] = QString::number(1 + below(10));
+				}
+
+				bool const nested = chance(15);
+				QStringList const liked = history(history_length(), nested);
+				if(chance(40)) {
+					entry[Field::Progress] = u"Finished"_qs;
+				}
+				else if(!liked.isEmpty()) {
+					entry[Field::Progress] = u"Chapter "_qs + liked.back().section(u'~', -1);
+				}
+				if(chance(20)) {
+					entry[Field::Notes] = u"Read on "_qs + pick(languages) + u" site; "_qs + english_title().toLower();
+				}
+				entry.add_chapters(liked, ChapterList::liked);
+				if(chance(30)) {
+					entry.add_chapters(history(1 + below(5), nested), ChapterList::loved);
+				}
+				entries.add_entry(std::move(entry));
+			}
+		}
+
+		// Write the given generated entries as a library to the save file at the given path.
+		static bool write(QString const &path, Entries const &entries) {
+			QSaveFile file(path);
+			if(!file.open(QIODevice::WriteOnly)) {
+				return false;
+			}
+			JsonWriter writer(file);
+			writer.begin_object();
+			entries.to_writer(writer);
+			writer.end_object();
+			if(!writer.flush() || !file.commit()) {
+				return false;
+			}
+
+			// Loading counts the entries, so saving the library again fills in the counts and the rest of the save,
+			// with the entries sorted as in any other save.
+			Save save;
+			if(!save.load(path)) {
+				return false;
+			}
+			save.refresh();
+			return save.save(path);
+		}
+	};
+} // namespace omm
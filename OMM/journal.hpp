@@ -0,0 +1,171 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QString>
+#include <QtDebug>
+#include <utility>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The class that keeps an append-only journal of the edits made since the last full save,
+	// one compact JSON object per line, so that saving an edit only writes the edit.
+	// The first line holds the generation of the full save that the journal applies on top of.
+	class Journal {
+		private:
+		// The path of the journal file.
+		QString path;
+		// The records not written to the journal file yet.
+		QByteArray pending;
+		// The number of records in the journal, written or not.
+		qsizetype recordCount;
+
+		// Append the given record to the pending records.
+		void append(QJsonObject const &record) {
+			pending.append(QJsonDocument(record).toJson(QJsonDocument::Compact));
+			pending.append('\n');
+		}
+
+		public:
+		// The number of records after which the journal should be folded back into a full save.
+		static constexpr qsizetype compactThreshold = 4096;
+
+		// Constructor that takes the path of the journal file.
+		explicit Journal(QString _path): path(std::move(_path)), pending(), recordCount(0) {}
+
+		// Returns the path of the journal file that goes with the save file at the given path.
+		static QString path_for(QString const &savePath) {
+			return savePath + u".journal"_qs;
+		}
+
+		// Use the journal file at the given path from now on.
+		void set_path(QString _path) {
+			path = std::move(_path);
+		}
+
+		// A position in the journal: the number of records before it, and how many of their bytes are pending.
+		struct Mark {
+			qsizetype records;
+			qsizetype pendingBytes;
+		};
+
+		// Returns the current end of the journal.
+		Mark mark() const noexcept {
+			return Mark{recordCount, pending.size()};
+		}
+
+		// Drop the records before the given mark, which a full save taken at that mark now holds;
+		// the records after it must not have been written to the journal file yet.
+		void drop_through(Mark const &mark) {
+			pending.remove(0, mark.pendingBytes);
+			recordCount -= mark.records;
+		}
+
+		// Returns the number of records in the journal, written or not.
+		qsizetype size() const noexcept {
+			return recordCount;
+		}
+
+		// Returns true if there are records not written to the journal file yet.
+		bool has_pending() const noexcept {
+			return !pending.isEmpty();
+		}
+
+		// Add the given record to the journal; it is written with the next flush().
+		void record(QJsonObject const &record) {
+			append(record);
+			++recordCount;
+		}
+
+		// Append the pending records to the journal file, starting it for the given generation if it is empty.
+		bool flush(qint64 const generation) {
+			if(pending.isEmpty()) {
+				return true;
+			}
+
+			QFile file(path);
+			if(!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+				qWarning() << u"Could not open journal file."_qs;
+
+				return false;
+			}
+
+			if(file.size() == 0) {
+				QByteArray records;
+				records.swap(pending);
+				append(QJsonObject{{u"Generation"_qs, generation}});
+				pending.append(records);
+			}
+			if(file.write(pending) != pending.size() || !file.flush()) {
+				qWarning() << u"Could not write journal file."_qs;
+
+				return false;
+			}
+			pending.clear();
+
+			return true;
+		}
+
+		// Remove the journal file and all records, since a full save now holds every edit.
+		void clear() {
+			pending.clear();
+			recordCount = 0;
+			if(QFile::exists(path)) {
+				QFile::remove(path);
+			}
+		}
+
+		// Call apply with each record in the journal file, if it was started for the given generation.
+		// A journal for another generation is left over from before the last full save and is removed,
+		// and a damaged record at the end (from a crash midway through writing it) is cut off.
+		template<typename Apply>
+		bool replay(qint64 const generation, Apply &&apply) {
+			pending.clear();
+			recordCount = 0;
+			QFile file(path);
+			if(!file.exists()) {
+				return true;
+			}
+			if(!file.open(QIODevice::ReadWrite)) {
+				qWarning() << u"Could not open journal file."_qs;
+
+				return false;
+			}
+
+			bool started = false;
+			qint64 good = 0;
+			while(!file.atEnd()) {
+				QByteArray const line = file.readLine();
+				QJsonParseError error;
+				QJsonDocument const document = QJsonDocument::fromJson(line, &error);
+				if(!line.endsWith('\n') || error.error != QJsonParseError::NoError || !document.isObject()) {
+					qWarning() << u"Cut off a damaged record at the end of the journal file."_qs;
+					file.resize(good);
+					break;
+				}
+
+				QJsonObject const record = document.object();
+				if(!started) {
+					if(record[u"Generation"_qs].toInteger(-1) != generation) {
+						qWarning() << u"Removed a journal file left over from an earlier save."_qs;
+						file.close();
+						file.remove();
+
+						return true;
+					}
+					started = true;
+				}
+				else {
+					apply(record);
+					++recordCount;
+				}
+				good = file.pos();
+			}
+
+			return true;
+		}
+	};
+} // namespace omm
@@ -0,0 +1,416 @@
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QStringDecoder>
+#include <cstdint>
+
+#include "stringarena.hpp"
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// Enum for the kinds of JSON values.
+	enum class JsonType : int { Object, Array, String, Number, Literal, End };
+
+	// The class that reads JSON incrementally from a device without building a document,
+	// so that only a small buffer of the input is in memory at any time.
+	class JsonReader {
+		private:
+		// The number of bytes read from the device at a time.
+		static constexpr qint64 chunkSize = 64 * 1024;
+
+		// The device to read from.
+		QIODevice &device;
+		// The bytes read from the device that have not been consumed yet start at pos.
+		QByteArray buffer;
+		// The position of the next byte to consume in the buffer.
+		qsizetype pos;
+		// Scratch space for the bytes of the string or number being read.
+		QByteArray scratch;
+		// The last key read, whose memory is reused for the next key.
+		QString keyText;
+		// Set when the input turned out not to be valid JSON.
+		bool failed;
+
+		// Read the next chunk from the device; returns false at the end of the input.
+		bool refill() {
+			buffer.resize(chunkSize);
+			qint64 const read = device.read(buffer.data(), chunkSize);
+			buffer.resize(read > 0 ? static_cast<qsizetype>(read) : 0);
+			pos = 0;
+			return read > 0;
+		}
+
+		// Consume the next byte; returns false at the end of the input.
+		bool get(char &c) {
+			if(pos == buffer.size() && !refill()) {
+				return false;
+			}
+			c = buffer[pos++];
+			return true;
+		}
+
+		// Returns the next byte that is not whitespace without consuming it, or 0 at the end of the input.
+		char peek() {
+			for(;;) {
+				if(pos == buffer.size() && !refill()) {
+					return '\0';
+				}
+				char const c = buffer[pos];
+				if(c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+					return c;
+				}
+				++pos;
+			}
+		}
+
+		// Mark the input as invalid; always returns false.
+		bool fail() {
+			failed = true;
+			return false;
+		}
+
+		// Consume the given byte, which must come next (after any whitespace).
+		bool expect(char const c) {
+			if(peek() != c) {
+				return fail();
+			}
+			++pos;
+			return true;
+		}
+
+		// Append the given code point to the scratch space in UTF-8.
+		void append_utf8(char32_t const cp) {
+			if(cp < 0x80) {
+				scratch.append(static_cast<char>(cp));
+			}
+			else if(cp < 0x800) {
+				scratch.append(static_cast<char>(0xC0 | (cp >> 6)));
+				scratch.append(static_cast<char>(0x80 | (cp & 0x3F)));
+			}
+			else if(cp < 0x10000) {
+				scratch.append(static_cast<char>(0xE0 | (cp >> 12)));
+				scratch.append(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+				scratch.append(static_cast<char>(0x80 | (cp & 0x3F)));
+			}
+			else {
+				scratch.append(static_cast<char>(0xF0 | (cp >> 18)));
+				scratch.append(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+				scratch.append(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+				scratch.append(static_cast<char>(0x80 | (cp & 0x3F)));
+			}
+		}
+
+		// Read the four hexadecimal digits of a \u escape sequence.
+		bool read_hex(char32_t &value) {
+			value = 0;
+			for(int a = 0; a < 4; ++a) {
+				char c;
+				if(!get(c)) {
+					return fail();
+				}
+				value <<= 4;
+				if(c >= '0' && c <= '9') {
+					value |= static_cast<char32_t>(c - '0');
+				}
+				else if(c >= 'a' && c <= 'f') {
+					value |= static_cast<char32_t>(c - 'a' + 10);
+				}
+				else if(c >= 'A' && c <= 'F') {
+					value |= static_cast<char32_t>(c - 'A' + 10);
+				}
+				else {
+					return fail();
+				}
+			}
+			return true;
+		}
+
+		// Read the escape sequence after a backslash into the scratch space.
+		bool read_escape() {
+			char c;
+			if(!get(c)) {
+				return fail();
+			}
+			switch(c) {
+				case '"':
+				case '\\':
+				case '/':
+					scratch.append(c);
+					return true;
+				case 'b':
+					scratch.append('\b');
+					return true;
+				case 'f':
+					scratch.append('\f');
+					return true;
+				case 'n':
+					scratch.append('\n');
+					return true;
+				case 'r':
+					scratch.append('\r');
+					return true;
+				case 't':
+					scratch.append('\t');
+					return true;
+				case 'u': {
+					char32_t cp;
+					if(!read_hex(cp)) {
+						return false;
+					}
+					// Combine a surrogate pair into a single code point.
+					if(cp >= 0xD800 && cp < 0xDC00) {
+						char32_t low;
+						char b1, b2;
+						if(!get(b1) || !get(b2) || b1 != '\\' || b2 != 'u' || !read_hex(low) || low < 0xDC00 || low >= 0xE000) {
+							return fail();
+						}
+						cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+					}
+					append_utf8(cp);
+					return true;
+				}
+				default:
+					return fail();
+			}
+		}
+
+		// Read the raw bytes of a string into the scratch space, decoding any escape sequences.
+		bool read_string_bytes() {
+			if(!expect('"')) {
+				return false;
+			}
+			scratch.resize(0);
+			for(;;) {
+				if(pos == buffer.size() && !refill()) {
+					return fail();
+				}
+
+				// Copy the run of bytes up to the next quote or backslash at once.
+				auto const begin = buffer.constData() + pos, end = buffer.constData() + buffer.size();
+				auto it = begin;
+				while(it != end && *it != '"' && *it != '\\') {
+					++it;
+				}
+				scratch.append(begin, static_cast<qsizetype>(it - begin));
+				pos += it - begin;
+				if(it == end) {
+					continue;
+				}
+
+				++pos;
+				if(*it == '"') {
+					return true;
+				}
+				if(!read_escape()) {
+					return false;
+				}
+			}
+		}
+
+		// Convert the bytes in the scratch space like QString::fromUtf8() into the given string,
+		// reusing its memory if it is not shared and large enough.
+		void decode_scratch(QString &value) const {
+			// UTF-16 never takes more code units than UTF-8 takes bytes.
+			value.resize(scratch.size());
+			QStringDecoder decoder(
+					QStringDecoder::Utf8, QStringDecoder::Flag::Stateless | QStringDecoder::Flag::ConvertInitialBom);
+			value.truncate(decoder.appendToBuffer(value.data(), scratch) - value.constData());
+		}
+
+		// Read the raw bytes of a number into the scratch space; returns false if there are none.
+		bool read_number_bytes() {
+			peek();
+			scratch.resize(0);
+			for(;;) {
+				if(pos == buffer.size() && !refill()) {
+					break;
+				}
+				char const c = buffer[pos];
+				if(!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+					break;
+				}
+				scratch.append(c);
+				++pos;
+			}
+			return !scratch.isEmpty();
+		}
+
+		// Consume the letters of a literal (true, false, or null).
+		bool read_literal() {
+			peek();
+			qsizetype length = 0;
+			for(;;) {
+				if(pos == buffer.size() && !refill()) {
+					break;
+				}
+				if(char const c = buffer[pos]; c < 'a' || c > 'z') {
+					break;
+				}
+				++pos, ++length;
+			}
+			return length > 0 || fail();
+		}
+
+		public:
+		// Constructor that takes the device to read from, which must already be open.
+		explicit JsonReader(QIODevice &_device): device(_device), buffer(), pos(0), scratch(), keyText(), failed(false) {}
+
+		// Returns true if the input turned out not to be valid JSON.
+		bool has_error() const noexcept {
+			return failed;
+		}
+
+		// Returns the type of the next value without consuming it.
+		JsonType peek_type() {
+			switch(peek()) {
+				case '{':
+					return JsonType::Object;
+				case '[':
+					return JsonType::Array;
+				case '"':
+					return JsonType::String;
+				case 't':
+				case 'f':
+				case 'n':
+					return JsonType::Literal;
+				case '\0':
+					return JsonType::End;
+				default:
+					return JsonType::Number;
+			}
+		}
+
+		// Consume the start of an object.
+		bool enter_object() {
+			return expect('{');
+		}
+
+		// Consume the start of an array.
+		bool enter_array() {
+			return expect('[');
+		}
+
+		// Read the key of the next member of the current object, leaving its value next;
+		// returns false once the end of the object is consumed (or on an error).
+		// The key shares its memory with the reader, so reading keys allocates nothing unless the previous key is kept.
+		bool next_key(QString &key) {
+			if(failed) {
+				return false;
+			}
+
+			char c = peek();
+			if(c == ',') {
+				++pos;
+				c = peek();
+			}
+			if(c == '}') {
+				++pos;
+				return false;
+			}
+
+			// Let go of the previous key so that its memory can be reused.
+			key = QString();
+			if(!read_string(keyText)) {
+				return false;
+			}
+			key = keyText;
+			return expect(':');
+		}
+
+		// Move on to the next element of the current array;
+		// returns false once the end of the array is consumed (or on an error).
+		bool next_element() {
+			if(failed) {
+				return false;
+			}
+
+			char c = peek();
+			if(c == ',') {
+				++pos;
+				c = peek();
+			}
+			if(c == ']') {
+				++pos;
+				return false;
+			}
+
+			return c != '\0' || fail();
+		}
+
+		// Read a string value, reusing the memory of the given string if it is not shared and large enough.
+		bool read_string(QString &value) {
+			if(!read_string_bytes()) {
+				return false;
+			}
+			decode_scratch(value);
+			return true;
+		}
+
+		// Read a string value into the given arena, as a view of its buffers.
+		bool read_string(QString &value, StringArena &arena) {
+			if(!read_string_bytes()) {
+				return false;
+			}
+			value = arena.store(scratch);
+			return true;
+		}
+
+		// Read a number value.
+		bool read_number(double &value) {
+			bool ok = false;
+			value = read_number_bytes() ? scratch.toDouble(&ok) : 0.0;
+			return ok || fail();
+		}
+
+		// Read a number value as an integer.
+		bool read_integer(qint64 &value) {
+			if(!read_number_bytes()) {
+				return fail();
+			}
+
+			bool ok = false;
+			value = scratch.toLongLong(&ok);
+			if(!ok) {
+				value = static_cast<qint64>(scratch.toDouble(&ok));
+			}
+			return ok || fail();
+		}
+
+		// Skip the next value, whatever it is.
+		bool skip_value() {
+			switch(peek_type()) {
+				case JsonType::Object: {
+					enter_object();
+					QString key;
+					while(next_key(key)) {
+						skip_value();
+					}
+					break;
+				}
+				case JsonType::Array:
+					enter_array();
+					while(next_element()) {
+						skip_value();
+					}
+					break;
+				case JsonType::String:
+					read_string_bytes();
+					break;
+				case JsonType::Literal:
+					read_literal();
+					break;
+				case JsonType::Number:
+					if(!read_number_bytes()) {
+						fail();
+					}
+					break;
+				case JsonType::End:
+					fail();
+					break;
+			}
+			return !failed;
+		}
+	};
+} // namespace omm
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QStringView>
+#include <vector>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The class that writes JSON incrementally to a device through a small buffer,
+	// in the same indented format as QJsonDocument::toJson().
+	class JsonWriter {
+		private:
+		// The number of buffered bytes at which the buffer is written to the device.
+		static constexpr qsizetype flushSize = 64 * 1024;
+
+		// The device to write to.
+		QIODevice &device;
+		// The bytes not written to the device yet.
+		QByteArray buffer;
+		// For each open object or array, whether it has any members or elements yet.
+		std::vector<bool> levels;
+		// Set when writing to the device failed.
+		bool failed;
+
+		// Write the buffer to the device once it is large enough.
+		void maybe_flush() {
+			if(buffer.size() >= flushSize) {
+				flush();
+			}
+		}
+
+		// Start a new line indented to the current level.
+		void new_line() {
+			buffer.append('\n');
+			buffer.append(static_cast<qsizetype>(levels.size()) * 4, ' ');
+		}
+
+		// Separate the next member or element from the previous one.
+		void next_item() {
+			if(!levels.empty()) {
+				if(levels.back()) {
+					buffer.append(',');
+				}
+				levels.back() = true;
+				new_line();
+			}
+		}
+
+		// Open an object or array with the given symbol.
+		void open(char const symbol) {
+			buffer.append(symbol);
+			levels.push_back(false);
+		}
+
+		// Close the current object or array with the given symbol.
+		void close(char const symbol) {
+			levels.pop_back();
+			new_line();
+			buffer.append(symbol);
+			if(levels.empty()) {
+				buffer.append('\n');
+			}
+			maybe_flush();
+		}
+
+		// Append the given string in quotes, escaped the same way as QJsonDocument and encoded in UTF-8.
+		void append_string(QStringView const string) {
+			static constexpr char hex[] = "0123456789abcdef";
+			buffer.append('"');
+			auto const end = string.utf16() + string.size();
+			for(auto it = string.utf16(); it != end; ++it) {
+				char32_t cp = *it;
+				switch(cp) {
+					case u'"':
+						buffer.append("\\\"");
+						continue;
+					case u'\\':
+						buffer.append("\\\\");
+						continue;
+					case u'\b':
+						buffer.append("\\b");
+						continue;
+					case u'\f':
+						buffer.append("\\f");
+						continue;
+					case u'\n':
+						buffer.append("\\n");
+						continue;
+					case u'\r':
+						buffer.append("\\r");
+						continue;
+					case u'\t':
+						buffer.append("\\t");
+						continue;
+					default:
+						break;
+				}
+
+				if(cp < 0x20) {
+					buffer.append("\\u00");
+					buffer.append(hex[cp >> 4]);
+					buffer.append(hex[cp & 0xF]);
+				}
+				else if(cp < 0x80) {
+					buffer.append(static_cast<char>(cp));
+				}
+				else if(cp < 0x800) {
+					buffer.append(static_cast<char>(0xC0 | (cp >> 6)));
+					buffer.append(static_cast<char>(0x80 | (cp & 0x3F)));
+				}
+				else {
+					// Combine a surrogate pair into a single code point.
+					if(cp >= 0xD800 && cp < 0xDC00 && it + 1 != end && it[1] >= 0xDC00 && it[1] < 0xE000) {
+						cp = 0x10000 + ((cp - 0xD800) << 10) + (*++it - 0xDC00);
+					}
+					if(cp < 0x10000) {
+						buffer.append(static_cast<char>(0xE0 | (cp >> 12)));
+					}
+					else {
+						buffer.append(static_cast<char>(0xF0 | (cp >> 18)));
+						buffer.append(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+					}
+					buffer.append(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+					buffer.append(static_cast<char>(0x80 | (cp & 0x3F)));
+				}
+			}
+			buffer.append('"');
+		}
+
+		public:
+		// Constructor that takes the device to write to, which must already be open.
+		explicit JsonWriter(QIODevice &_device): device(_device), buffer(), levels(), failed(false) {
+			buffer.reserve(flushSize + 1024);
+		}
+
+		// Write any buffered bytes when done.
+		~JsonWriter() {
+			flush();
+		}
+
+		JsonWriter(JsonWriter const &) = delete;
+		JsonWriter &operator=(JsonWriter const &) = delete;
+
+		// Returns true if writing to the device failed.
+		bool has_error() const noexcept {
+			return failed;
+		}
+
+		// Write all buffered bytes to the device.
+		bool flush() {
+			if(!buffer.isEmpty()) {
+				if(device.write(buffer) != buffer.size()) {
+					failed = true;
+				}
+				buffer.resize(0);
+			}
+			return !failed;
+		}
+
+		// Start an object as the next value.
+		void begin_object() {
+			open('{');
+		}
+
+		// End the current object.
+		void end_object() {
+			close('}');
+		}
+
+		// Start an array as the next value.
+		void begin_array() {
+			open('[');
+		}
+
+		// End the current array.
+		void end_array() {
+			close(']');
+		}
+
+		// Write the key of the next member of the current object; the value must follow.
+		void key(QStringView const key) {
+			next_item();
+			append_string(key);
+			buffer.append(": ");
+		}
+
+		// Write the key of the next member of the current object and start an object as its value.
+		void begin_object(QStringView const key) {
+			this->key(key);
+			begin_object();
+		}
+
+		// Write the key of the next member of the current object and start an array as its value.
+		void begin_array(QStringView const key) {
+			this->key(key);
+			begin_array();
+		}
+
+		// Write a string as the value after a key.
+		void value(QStringView const value) {
+			append_string(value);
+		}
+
+		// Write an integer as the value after a key.
+		void value(qint64 const value) {
+			buffer.append(QByteArray::number(value));
+		}
+
+		// Write a string as the next element of the current array.
+		void element(QStringView const value) {
+			next_item();
+			append_string(value);
+		}
+
+		// Write an integer as the next element of the current array.
+		void element(qint64 const value) {
+			next_item();
+			this->value(value);
+		}
+
+		// Move on to the next element of the current array, which must be written next.
+		void next_element() {
+			next_item();
+		}
+
+		// Write a string member of the current object.
+		void member(QStringView const key, QStringView const value) {
+			this->key(key);
+			append_string(value);
+		}
+
+		// Write an integer member of the current object.
+		void member(QStringView const key, qint64 const value) {
+			this->key(key);
+			this->value(value);
+		}
+	};
+} // namespace omm
@@ -1,11 +1,241 @@
 #include "omm.hpp"
 
+#include <QFile>
+#include <QHeaderView>
+#include <QtConcurrent>
+#include <utility>
+
 #include "ui_omm.h"
 
-OMM::OMM(QWidget *parent): QWidget(parent), ui(new Ui::OMM) {
+#ifdef OMM_PROFILE
+#include "profileoverlay.hpp"
+#endif
+
+OMM::OMM(QWidget *parent):
+		QWidget(parent), ui(new Ui::OMM), save(std::make_shared<omm::Save>()), model(new omm::EntryModel(*save, this)),
+		loadProgress(), saveProgress(), sortProgress(), loadWatcher(), saveWatcher(), sortWatcher(), savingCopy(false),
+		pendingLoadPath(), progressTimer(), autoSave() {
 	ui->setupUi(this);
+
+	// The view only asks the model for the rows that are visible; fixed row heights keep it from measuring the rest.
+	ui->entryView->setModel(model);
+	ui->entryView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	ui->entryView->setSortingEnabled(true);
+	connect(ui->searchEdit, &QLineEdit::textChanged, model, &omm::EntryModel::set_search);
+
+	ui->progressBar->hide();
+	ui->cancelButton->hide();
+	connect(ui->cancelButton, &QPushButton::clicked, this, &OMM::cancel);
+	connect(&progressTimer, &QTimer::timeout, this, &OMM::show_progress);
+	connect(&loadWatcher, &QFutureWatcher<std::shared_ptr<omm::Save>>::finished, this, &OMM::finish_load);
+	connect(&saveWatcher, &QFutureWatcher<std::shared_ptr<omm::Save>>::finished, this, &OMM::finish_save);
+	connect(&sortWatcher, &QFutureWatcher<std::vector<omm::EntryVector::size_type>>::finished, this, &OMM::finish_sort);
+	connect(model, &omm::EntryModel::sort_requested, this, &OMM::start_sort);
+	// Every edit of the save is journaled, whether made through the model or not, and each calls for a save.
+	save->set_edit_listener([this]() {
+		autoSave.note_edit();
+	});
+	connect(&autoSave, &omm::AutoSave::save_due, this, &OMM::autosave);
+#ifdef OMM_PROFILE
+	// Owned by this widget, like the widgets of the form.
+	new omm::ProfileOverlay(this);
+#endif
+
+	if(QFile::exists(u"omm.json"_qs)) {
+		start_load();
+	}
 }
 
 OMM::~OMM() {
+	// A save being saved is let finish, since the edits made before it started are only in the copy.
+	loadProgress.cancel();
+	sortProgress.cancel();
+	pendingLoadPath.clear();
+	loadWatcher.waitForFinished();
+	sortWatcher.waitForFinished();
+	saveWatcher.waitForFinished();
+	if(savingCopy) {
+		end_copy_save();
+	}
+
+	// Save the edits made since, waiting for the full save if one is needed;
+	// if it fails, the edits are journaled instead so that they are not lost.
+	save_edits();
+	saveWatcher.waitForFinished();
+	if(savingCopy) {
+		end_copy_save();
+		save->save_journal();
+	}
 	delete ui;
 }
+
+void OMM::show_progress() {
+	omm::Progress const *progress = nullptr;
+	if(loadWatcher.isRunning()) {
+		progress = &loadProgress;
+	}
+	else if(saveWatcher.isRunning()) {
+		progress = &saveProgress;
+	}
+	else if(sortWatcher.isRunning()) {
+		progress = &sortProgress;
+	}
+
+	if(!progress) {
+		progressTimer.stop();
+		ui->progressBar->hide();
+		ui->cancelButton->hide();
+
+		return;
+	}
+
+	// The number of entries is not known while loading, so the bar only shows that it is busy until it is.
+	auto const total = progress->get_total();
+	ui->progressBar->setRange(0, total > 0 ? 1000 : 0);
+	ui->progressBar->setValue(total > 0 ? static_cast<int>(progress->get_done() * 1000 / total) : 0);
+	ui->progressBar->show();
+	ui->cancelButton->show();
+}
+
+void OMM::finish_load() {
+	auto loaded = loadWatcher.result();
+	if(loaded) {
+		loaded->set_edit_listener([this]() {
+			autoSave.note_edit();
+		});
+		model->set_save(*loaded);
+		save = std::move(loaded);
+		autoSave.note_saved();
+	}
+	// The old save is kept if the load failed or was cancelled.
+	ui->entryView->setEnabled(true);
+	show_progress();
+}
+
+void OMM::end_copy_save() {
+	save->end_copy_save(saveWatcher.result().get());
+	savingCopy = false;
+}
+
+void OMM::finish_save() {
+	bool const saved = saveWatcher.result() != nullptr;
+	end_copy_save();
+	show_progress();
+	if(!saved) {
+		// The edits stay in the journal to be saved by the next autosave, and a load waiting for them is dropped
+		// rather than discarding them.
+		pendingLoadPath.clear();
+
+		return;
+	}
+
+	// Write the edits made while the copy was being saved, then load the save waiting for them, if any.
+	save_edits();
+	if(!pendingLoadPath.isEmpty() && !saveWatcher.isRunning()) {
+		start_load(std::exchange(pendingLoadPath, QString()));
+	}
+}
+
+void OMM::finish_sort() {
+	auto const order = sortWatcher.result();
+	// The entries keep their order if the sort was cancelled.
+	if(!order.empty()) {
+		model->apply_sort(order);
+	}
+	ui->entryView->setEnabled(true);
+	show_progress();
+}
+
+void OMM::save_edits() {
+	// Appending to the journal is cheap, but a full save is done on another thread.
+	if(save->needs_full_save()) {
+		start_save();
+	}
+	else {
+		save->save_journal();
+	}
+}
+
+void OMM::autosave() {
+	if(!save->has_unsaved_changes() || saveWatcher.isRunning() || loadWatcher.isRunning() || sortWatcher.isRunning()) {
+		return;
+	}
+
+	save_edits();
+}
+
+void OMM::start_load(QString const &path) {
+	if(loadWatcher.isRunning() || sortWatcher.isRunning()) {
+		return;
+	}
+
+	// A save being saved must be done before another one is swapped in, and so must a full save that the save being
+	// replaced needs to keep its edits.
+	if(saveWatcher.isRunning() || save->needs_full_save()) {
+		pendingLoadPath = path;
+		start_save();
+
+		return;
+	}
+
+	// The save being replaced keeps its edits, and no more are made to it until the loaded save is swapped in.
+	save->save_journal();
+	ui->entryView->setEnabled(false);
+
+	loadProgress.reset();
+	loadWatcher.setFuture(QtConcurrent::run([path, progress = &loadProgress]() -> std::shared_ptr<omm::Save> {
+		auto loaded = std::make_shared<omm::Save>();
+		if(!loaded->load(path, progress)) {
+			return nullptr;
+		}
+		loaded->refresh();
+		return loaded;
+	}));
+	progressTimer.start(100);
+}
+
+void OMM::start_save() {
+	if(saveWatcher.isRunning() || loadWatcher.isRunning() || sortWatcher.isRunning()) {
+		return;
+	}
+
+	// The copy is taken on the other thread too, so the save cannot be edited until it is.
+	saveProgress.reset();
+	autoSave.note_saved();
+	save->begin_copy_save();
+	savingCopy = true;
+	ui->entryView->setEnabled(false);
+	auto const run = [this, source = save, progress = &saveProgress]() -> std::shared_ptr<omm::Save> {
+		auto copy = source->copy_for_save();
+		QMetaObject::invokeMethod(
+				this,
+				[this]() {
+					ui->entryView->setEnabled(true);
+				},
+				Qt::QueuedConnection);
+		return copy->save_file(progress) ? copy : nullptr;
+	};
+	saveWatcher.setFuture(QtConcurrent::run(run));
+	progressTimer.start(100);
+}
+
+void OMM::start_sort() {
+	if(saveWatcher.isRunning() || loadWatcher.isRunning() || sortWatcher.isRunning()) {
+		return;
+	}
+
+	// Only the order of the entries changes once the work is done, so the save stays shown meanwhile.
+	ui->entryView->setEnabled(false);
+	sortProgress.reset();
+	sortWatcher.setFuture(QtConcurrent::run([source = save, progress = &sortProgress]() {
+		return source->prepare_refresh(progress);
+	}));
+	progressTimer.start(100);
+}
+
+void OMM::cancel() {
+	loadProgress.cancel();
+	saveProgress.cancel();
+	sortProgress.cancel();
+	pendingLoadPath.clear();
+}
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <QFutureWatcher>
+#include <QTimer>
 #include <QWidget>
+#include <memory>
+#include <vector>
 
+#include "autosave.hpp"
+#include "entrymodel.hpp"
+#include "progress.hpp"
 #include "save.hpp"
 
 QT_BEGIN_NAMESPACE
@@ -16,9 +23,61 @@ class OMM: public QWidget {
 	private:
 	Ui::OMM *ui;
 	// The current save file.
-	omm::Save save;
+	std::shared_ptr<omm::Save> save;
+	// The model that shows the entries of the save in the entry view.
+	omm::EntryModel *model;
+	// The progress of the save being loaded on another thread.
+	omm::Progress loadProgress;
+	// The progress of the copy of the save being saved on another thread.
+	omm::Progress saveProgress;
+	// The progress of the entries being sorted on another thread.
+	omm::Progress sortProgress;
+	// Watches the save being loaded on another thread, which is swapped in once it is ready.
+	QFutureWatcher<std::shared_ptr<omm::Save>> loadWatcher;
+	// Watches the copy of the save being saved on another thread, which gives the copy once saved or nullptr if not.
+	QFutureWatcher<std::shared_ptr<omm::Save>> saveWatcher;
+	// Watches the new order of the entries being worked out on another thread, which is applied once it is ready.
+	QFutureWatcher<std::vector<omm::EntryVector::size_type>> sortWatcher;
+	// Set from the start of saving a copy of the save on another thread until its result is taken over.
+	bool savingCopy;
+	// The path of the save to load once the full save of the current save that it waits for is done, if any.
+	QString pendingLoadPath;
+	// Updates the progress bar while a load or save is running.
+	QTimer progressTimer;
+	// Decides when to save the edits made through the model.
+	omm::AutoSave autoSave;
+
+	// Show the progress of the running load, save, or sort, or hide the progress bar if none is running.
+	void show_progress();
+	// Swap in the save loaded on another thread.
+	void finish_load();
+	// Take over the result of saving the copy of the save on another thread.
+	void end_copy_save();
+	// Take over the result of saving the copy of the save on another thread, then save the edits made meanwhile and
+	// start the load waiting for it, if any; nothing more is saved if it failed or was cancelled.
+	void finish_save();
+	// Put the entries in the order worked out on another thread.
+	void finish_sort();
+	// Save the edits made since the last save by appending them to the journal, or start a full save on another
+	// thread instead if the save needs one (see Save::needs_full_save()); never blocks on a full save.
+	void save_edits();
+	// Save the edits made since the last save, if any, unless a load, save, or sort is running.
+	void autosave();
 
 	public:
 	OMM(QWidget *parent = nullptr);
 	~OMM();
+
+	// Load the save at the given path on another thread; the current save has its edits saved and stays shown,
+	// but cannot be edited, until it is ready. If the current save needs a full save first, that is started instead
+	// and the load follows once it is done.
+	void start_load(QString const &path = u"omm.json"_qs);
+	// Save a copy of the save on another thread; the save cannot be edited until the copy is taken on that thread,
+	// and the edits made after that are journaled once it is done.
+	void start_save();
+	// Sort the entries on another thread; the save stays shown, but cannot be edited, until they are sorted.
+	void start_sort();
+	// Cancel the running load, save, or sort, leaving the current save and the save file as they are,
+	// along with any load waiting for the save.
+	void cancel();
 };
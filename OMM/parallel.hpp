@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#ifdef OMM_COUNT_ALLOCATIONS
+#include "allocations.hpp"
+#endif
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The smallest amount of work worth splitting across threads.
+	inline constexpr std::size_t parallelThreshold = 4096;
+
+	// Returns the number of threads to use for the given setting and amount of work;
+	// a setting of 0 means one thread per hardware thread.
+	inline unsigned resolve_thread_count(unsigned const setting, std::size_t const size) {
+		if(size < parallelThreshold) {
+			return 1;
+		}
+
+		unsigned const threads = setting ? setting : std::max(std::thread::hardware_concurrency(), 1u);
+		return static_cast<unsigned>(std::min<std::size_t>(threads, size));
+	}
+
+	// Splits [0, size) into one contiguous chunk per thread and calls function(begin, end) for each chunk;
+	// the calling thread handles the first chunk itself.
+	// Where allocations are counted, those of the other threads are counted as made by the calling thread.
+	template<typename Function>
+	void parallel_chunks(std::size_t const size, unsigned const threads, Function &&function) {
+		if(threads <= 1) {
+			function(std::size_t(0), size);
+
+			return;
+		}
+
+#ifdef OMM_COUNT_ALLOCATIONS
+		std::vector<Allocations> allocations(threads, Allocations{0, 0});
+#endif
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1);
+		for(unsigned a = 1; a < threads; ++a) {
+			workers.emplace_back([&, size, threads, a]() {
+#ifdef OMM_COUNT_ALLOCATIONS
+				Allocations const before = get_allocations();
+#endif
+				function(size * a / threads, size * (a + 1) / threads);
+#ifdef OMM_COUNT_ALLOCATIONS
+				Allocations const after = get_allocations();
+				allocations[a] = Allocations{after.count - before.count, after.bytes - before.bytes};
+#endif
+			});
+		}
+		function(std::size_t(0), size / threads);
+		for(auto &worker: workers) {
+			worker.join();
+		}
+#ifdef OMM_COUNT_ALLOCATIONS
+		for(auto const &added: allocations) {
+			add_allocations(added);
+		}
+#endif
+	}
+
+	// Stable sort that sorts one chunk per thread and then merges the chunks pairwise;
+	// the result is exactly the same as that of std::stable_sort.
+	template<typename Iterator, typename Compare>
+	void parallel_stable_sort(Iterator const first, Iterator const last, unsigned const threads, Compare comp) {
+		auto const size = static_cast<std::size_t>(std::distance(first, last));
+		if(threads <= 1 || size < parallelThreshold) {
+			std::stable_sort(first, last, comp);
+
+			return;
+		}
+
+		// The boundaries of the chunks.
+		std::vector<Iterator> bounds;
+		bounds.reserve(threads + 1);
+		for(unsigned a = 0; a <= threads; ++a) {
+			bounds.push_back(std::next(first, static_cast<std::ptrdiff_t>(size * a / threads)));
+		}
+
+		// Sort each chunk.
+		parallel_chunks(threads, threads, [&](std::size_t const begin, std::size_t const end) {
+			for(auto a = begin; a < end; ++a) {
+				std::stable_sort(bounds[a], bounds[a + 1], comp);
+			}
+		});
+
+		// Merge neighbouring runs of chunks, doubling the run width each round.
+		for(std::size_t width = 1; width < threads; width *= 2) {
+			std::size_t const merges = (threads + 2 * width - 1) / (2 * width);
+			parallel_chunks(merges, static_cast<unsigned>(merges), [&](std::size_t const begin, std::size_t const end) {
+				for(auto a = begin; a < end; ++a) {
+					std::size_t const l = a * 2 * width, m = l + width, r = std::min<std::size_t>(l + 2 * width, threads);
+					if(m < r) {
+						std::inplace_merge(bounds[l], bounds[m], bounds[r], comp);
+					}
+				}
+			});
+		}
+	}
+} // namespace omm
@@ -0,0 +1,48 @@
+#include "profileoverlay.hpp"
+
+#include <QFontDatabase>
+#include <QShortcut>
+#include <QtDebug>
+
+#include "profiler.hpp"
+
+namespace omm {
+	ProfileOverlay::ProfileOverlay(QWidget *parent): QLabel(parent), updateTimer() {
+		setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+		setStyleSheet(u"background-color: rgba(0, 0, 0, 160); color: white; padding: 4px;"_qs);
+		setAttribute(Qt::WA_TransparentForMouseEvents);
+		move(8, 8);
+		hide();
+
+		connect(&updateTimer, &QTimer::timeout, this, &ProfileOverlay::update_counts);
+		connect(new QShortcut(Qt::Key_F12, parent), &QShortcut::activated, this, &ProfileOverlay::toggle);
+		connect(new QShortcut(Qt::CTRL | Qt::Key_F12, parent), &QShortcut::activated, this,
+				&ProfileOverlay::write_files);
+	}
+
+	void ProfileOverlay::update_counts() {
+		setText(Profiler::to_text());
+		adjustSize();
+	}
+
+	void ProfileOverlay::toggle() {
+		if(isVisible()) {
+			updateTimer.stop();
+			hide();
+
+			return;
+		}
+
+		update_counts();
+		show();
+		raise();
+		updateTimer.start(500);
+	}
+
+	void ProfileOverlay::write_files() {
+		if(!Profiler::write(u"omm-profile.json"_qs, Profiler::to_json()) ||
+				!Profiler::write(u"omm-trace.json"_qs, Profiler::to_trace())) {
+			qWarning() << u"Could not write profile files."_qs;
+		}
+	}
+} // namespace omm
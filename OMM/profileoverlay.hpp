@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QLabel>
+#include <QTimer>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The label that shows the counts of the profiler over the given widget in profiling builds (qmake CONFIG+=profile).
+	// F12 shows or hides it, and Ctrl+F12 writes the counts and the trace to omm-profile.json and omm-trace.json.
+	class ProfileOverlay: public QLabel {
+		Q_OBJECT
+
+		private:
+		// Updates the counts while they are shown.
+		QTimer updateTimer;
+
+		// Show the current counts.
+		void update_counts();
+		// Show or hide the counts.
+		void toggle();
+		// Write the counts and the trace to files in the working directory.
+		void write_files();
+
+		public:
+		// Constructor that takes the widget to show the counts over.
+		explicit ProfileOverlay(QWidget *parent);
+	};
+} // namespace omm
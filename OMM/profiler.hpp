@@ -0,0 +1,297 @@
+#pragma once
+
+// Profiling is compiled out unless OMM_PROFILE is defined (qmake CONFIG+=profile); the macros below then expand to
+// nothing and their arguments are not evaluated.
+#ifdef OMM_PROFILE
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QString>
+#include <QtGlobal>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "allocations.hpp"
+
+// Measure the rest of the enclosing scope as a run of the given section of the profiler (e.g. Load) that processes
+// the given number of entries.
+#define OMM_PROFILE_SCOPE(section, items) omm::ProfileScope ommProfileScope(omm::ProfileSection::section, items)
+// Correct the number of entries of the run measured by OMM_PROFILE_SCOPE() once it is known.
+#define OMM_PROFILE_ITEMS(items) ommProfileScope.set_items(items)
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The hot paths that the profiler measures.
+	enum class ProfileSection : std::size_t { Load, Save, Sort, ReCount, Organize };
+
+	// The class that collects how often the hot paths run, how long they take, how much they allocate, and how many
+	// entries they process, along with the recent runs of each thread for a trace.
+	// Each thread keeps its own counters, which only it writes, so measuring a run takes no locks.
+	class Profiler {
+		public:
+		// The number of sections.
+		static constexpr std::size_t sectionCount = 5;
+		// The number of recent runs kept for the trace of each thread.
+		static constexpr std::size_t traceCapacity = 4096;
+
+		// The counts of a section, summed over all threads.
+		struct Totals {
+			quint64 calls;
+			quint64 nanoseconds;
+			quint64 allocations;
+			quint64 items;
+		};
+
+		private:
+		// The counts of a section in one thread.
+		struct Counter {
+			std::atomic<quint64> calls{0};
+			std::atomic<quint64> nanoseconds{0};
+			std::atomic<quint64> allocations{0};
+			std::atomic<quint64> items{0};
+		};
+
+		// A run of a section in one thread, for the trace.
+		struct Event {
+			std::atomic<std::size_t> section{0};
+			std::atomic<qint64> start{0};
+			std::atomic<qint64> duration{0};
+			std::atomic<quint64> items{0};
+		};
+
+		// The counts and recent runs of one thread; only that thread writes them, and any thread may read them.
+		struct Thread {
+			// The number of the thread in the trace, which the threads that take over these counts share.
+			int id = 0;
+			// The counts of each section.
+			std::array<Counter, sectionCount> counters;
+			// The most recent runs, as a ring.
+			std::array<Event, traceCapacity> events;
+			// The number of runs recorded so far.
+			std::atomic<std::size_t> eventCount{0};
+		};
+
+		// The counts of the calling thread, which it hands back to the free list when it ends.
+		class ThreadHandle {
+			public:
+			// The counts of the thread.
+			Thread *const thread;
+
+			// Constructor that takes the counts of a thread that ended, if there is one, or adds new ones otherwise.
+			ThreadHandle(): thread(acquire()) {}
+
+			ThreadHandle(ThreadHandle const &) = delete;
+			ThreadHandle &operator=(ThreadHandle const &) = delete;
+
+			// Hand the counts back once the thread ends.
+			~ThreadHandle() {
+				std::lock_guard const lock(mutex);
+				freeThreads.push_back(thread);
+			}
+		};
+
+		// Guards the list of threads, which is only changed the first time each thread runs a section and when
+		// such a thread ends.
+		static inline std::mutex mutex;
+		// The counts of the threads that ran a section so far. They are kept after a thread ends, so that its counts
+		// stay in the totals, and taken over by the next thread that runs a section, so that there are only ever as
+		// many as threads ran a section at once.
+		static inline std::vector<std::unique_ptr<Thread>> threads;
+		// The counts of the threads that ended, which are free to be taken over.
+		static inline std::vector<Thread *> freeThreads;
+		// The time that the trace starts at.
+		static inline std::chrono::steady_clock::time_point const origin = std::chrono::steady_clock::now();
+
+		// Returns the counts that a thread that runs a section for the first time takes over.
+		static Thread *acquire() {
+			std::lock_guard const lock(mutex);
+			if(!freeThreads.empty()) {
+				Thread *const thread = freeThreads.back();
+				freeThreads.pop_back();
+				return thread;
+			}
+
+			auto &added = threads.emplace_back(std::make_unique<Thread>());
+			added->id = static_cast<int>(threads.size());
+			return added.get();
+		}
+
+		// Returns the counts of the calling thread, registering the thread the first time.
+		static Thread &this_thread() {
+			thread_local ThreadHandle const handle;
+			return *handle.thread;
+		}
+
+		// Add the given value to the given counter of the calling thread, which no other thread writes.
+		template<typename T>
+		static void add(std::atomic<T> &counter, T const value) noexcept {
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		public:
+		// Returns the name of the given section.
+		static QString name(ProfileSection const section) {
+			static std::array<QString, sectionCount> const names{
+					u"Load"_qs, u"Save"_qs, u"Sort"_qs, u"ReCount"_qs, u"Organize"_qs};
+			return names[static_cast<std::size_t>(section)];
+		}
+
+		// Returns the time since the trace started in nanoseconds.
+		static qint64 now() noexcept {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin)
+					.count();
+		}
+
+		// Record a run of the given section in the calling thread.
+		static void record(ProfileSection const section, qint64 const start, qint64 const duration,
+				quint64 const allocations, quint64 const items) noexcept {
+			Thread &thread = this_thread();
+			Counter &counter = thread.counters[static_cast<std::size_t>(section)];
+			add(counter.calls, quint64(1));
+			add(counter.nanoseconds, static_cast<quint64>(duration));
+			add(counter.allocations, allocations);
+			add(counter.items, items);
+
+			// Publish the run only once it is written, so that a reader does not see it half written
+			// (unless the ring wraps around while it reads).
+			std::size_t const count = thread.eventCount.load(std::memory_order_relaxed);
+			Event &event = thread.events[count % traceCapacity];
+			event.section.store(static_cast<std::size_t>(section), std::memory_order_relaxed);
+			event.start.store(start, std::memory_order_relaxed);
+			event.duration.store(duration, std::memory_order_relaxed);
+			event.items.store(items, std::memory_order_relaxed);
+			thread.eventCount.store(count + 1, std::memory_order_release);
+		}
+
+		// Returns the counts of each section, summed over all threads.
+		static std::array<Totals, sectionCount> get_totals() {
+			std::array<Totals, sectionCount> totals{};
+			std::lock_guard const lock(mutex);
+			for(auto const &thread: threads) {
+				for(std::size_t a = 0; a < sectionCount; ++a) {
+					Counter const &counter = thread->counters[a];
+					totals[a].calls += counter.calls.load(std::memory_order_relaxed);
+					totals[a].nanoseconds += counter.nanoseconds.load(std::memory_order_relaxed);
+					totals[a].allocations += counter.allocations.load(std::memory_order_relaxed);
+					totals[a].items += counter.items.load(std::memory_order_relaxed);
+				}
+			}
+			return totals;
+		}
+
+		// Returns the counts of each section as a JSON object, one member per section.
+		static QJsonObject to_json() {
+			auto const totals = get_totals();
+			QJsonObject json;
+			for(std::size_t a = 0; a < sectionCount; ++a) {
+				json[name(static_cast<ProfileSection>(a))] = QJsonObject{
+						{u"Calls"_qs, static_cast<qint64>(totals[a].calls)},
+						{u"Milliseconds"_qs, static_cast<double>(totals[a].nanoseconds) / 1e6},
+						{u"Allocations"_qs, static_cast<qint64>(totals[a].allocations)},
+						{u"Entries"_qs, static_cast<qint64>(totals[a].items)},
+				};
+			}
+			return json;
+		}
+
+		// Returns the recent runs of each thread in the Chrome trace format (for chrome://tracing or Perfetto).
+		static QJsonObject to_trace() {
+			QJsonArray events;
+			std::lock_guard const lock(mutex);
+			for(auto const &thread: threads) {
+				std::size_t const count = thread->eventCount.load(std::memory_order_acquire);
+				for(std::size_t a = count - std::min(count, traceCapacity); a < count; ++a) {
+					Event const &event = thread->events[a % traceCapacity];
+					events.append(QJsonObject{
+							{u"name"_qs, name(static_cast<ProfileSection>(event.section.load(std::memory_order_relaxed)))},
+							{u"cat"_qs, u"omm"_qs},
+							{u"ph"_qs, u"X"_qs},
+							{u"ts"_qs, static_cast<double>(event.start.load(std::memory_order_relaxed)) / 1e3},
+							{u"dur"_qs, static_cast<double>(event.duration.load(std::memory_order_relaxed)) / 1e3},
+							{u"pid"_qs, 1},
+							{u"tid"_qs, thread->id},
+							{u"args"_qs,
+									QJsonObject{{u"entries"_qs,
+											static_cast<qint64>(event.items.load(std::memory_order_relaxed))}}},
+					});
+				}
+			}
+			return QJsonObject{{u"traceEvents"_qs, events}, {u"displayTimeUnit"_qs, u"ms"_qs}};
+		}
+
+		// Returns the counts of each section as a table in plain text, one line per section.
+		static QString to_text() {
+			auto const totals = get_totals();
+			QString text = u"%1 %2 %3 %4 %5"_qs.arg(u"Section"_qs, -9)
+								   .arg(u"Calls"_qs, 9)
+								   .arg(u"ms"_qs, 11)
+								   .arg(u"Allocations"_qs, 12)
+								   .arg(u"Entries"_qs, 10);
+			for(std::size_t a = 0; a < sectionCount; ++a) {
+				text += u"\n%1 %2 %3 %4 %5"_qs.arg(name(static_cast<ProfileSection>(a)), -9)
+								.arg(totals[a].calls, 9)
+								.arg(static_cast<double>(totals[a].nanoseconds) / 1e6, 11, 'f', 1)
+								.arg(totals[a].allocations, 12)
+								.arg(totals[a].items, 10);
+			}
+			return text;
+		}
+
+		// Write the given JSON object (e.g. to_json() or to_trace()) to the file at the given path.
+		static bool write(QString const &path, QJsonObject const &json) {
+			QSaveFile file(path);
+			if(!file.open(QIODevice::WriteOnly)) {
+				return false;
+			}
+			file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+			return file.commit();
+		}
+	};
+
+	// The class that measures the rest of its scope as a run of a section; use it through OMM_PROFILE_SCOPE().
+	class ProfileScope {
+		private:
+		// The section being run.
+		ProfileSection section;
+		// The number of entries processed.
+		quint64 items;
+		// The time that the run started at.
+		qint64 start;
+		// The number of allocations made by this thread when the run started.
+		std::size_t allocations;
+
+		public:
+		// Constructor that starts a run of the given section, which processes the given number of entries.
+		ProfileScope(ProfileSection const _section, std::size_t const _items) noexcept:
+				section(_section), items(_items), start(Profiler::now()), allocations(get_allocations().count) {}
+
+		ProfileScope(ProfileScope const &) = delete;
+		ProfileScope &operator=(ProfileScope const &) = delete;
+
+		// Record the run; the allocations of the threads that it split its work across count towards it too (see
+		// parallel_chunks()), and those of other threads do not.
+		~ProfileScope() {
+			Profiler::record(section, start, Profiler::now() - start, get_allocations().count - allocations, items);
+		}
+
+		// Set the number of entries processed.
+		void set_items(std::size_t const _items) noexcept {
+			items = _items;
+		}
+	};
+} // namespace omm
+
+#else
+
+#define OMM_PROFILE_SCOPE(section, items) static_cast<void>(0)
+#define OMM_PROFILE_ITEMS(items) static_cast<void>(0)
+
+#endif
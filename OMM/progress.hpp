@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The number of entries that an operation running on several threads processes between advancing its progress,
+	// so that the threads do not all write to it for every entry.
+	inline constexpr qint64 progressInterval = 1024;
+
+	// The class that reports how far a long operation on another thread has got, and lets it be cancelled.
+	// The operation advances it as it processes entries, and any thread may read it or cancel the operation.
+	class Progress {
+		private:
+		// The number of entries processed so far.
+		std::atomic<qint64> done;
+		// The number of entries to process, or 0 if it is not known yet.
+		std::atomic<qint64> total;
+		// Set once the operation should stop.
+		std::atomic<bool> cancelled;
+
+		public:
+		Progress(): done(0), total(0), cancelled(false) {}
+
+		Progress(Progress const &) = delete;
+		Progress &operator=(Progress const &) = delete;
+
+		// Start over for a new operation.
+		void reset() noexcept {
+			done = 0;
+			total = 0;
+			cancelled = false;
+		}
+
+		// Set the number of entries to process.
+		void set_total(qint64 const count) noexcept {
+			total = count;
+		}
+
+		// Record that the given number of entries were processed; returns false if the operation should stop.
+		bool advance(qint64 const count = 1) noexcept {
+			done += count;
+			return !cancelled;
+		}
+
+		// Ask the operation to stop.
+		void cancel() noexcept {
+			cancelled = true;
+		}
+
+		// Returns true if the operation was asked to stop.
+		bool is_cancelled() const noexcept {
+			return cancelled;
+		}
+
+		// Get the number of entries processed so far.
+		qint64 get_done() const noexcept {
+			return done;
+		}
+
+		// Get the number of entries to process, or 0 if it is not known yet.
+		qint64 get_total() const noexcept {
+			return total;
+		}
+	};
+} // namespace omm
@@ -1,18 +1,30 @@
 #pragma once
 
 #include <QFile>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QString>
 #include <QtDebug>
+#include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "binaryformat.hpp"
 #include "counts.hpp"
 #include "entries.hpp"
+#include "journal.hpp"
+#include "jsonreader.hpp"
+#include "jsonwriter.hpp"
+#include "profiler.hpp"
+#include "progress.hpp"
 
 // Exclusive namespace for the OMM.
 namespace omm {
@@ -31,12 +43,112 @@ namespace omm {
 		Counts countsByProgress;
 		// The collection of all entries stored in this save.
 		Entries entries;
+		// The number of full saves of this save so far, which ties the journal to the full save it applies on top of.
+		qint64 generation;
+		// The path of the file that this save was last saved to or loaded from.
+		QString savePath;
+		// Set if that file is in the binary save format, so that full saves keep it in that format.
+		bool binaryFile;
+		// The journal of the edits made since the last full save.
+		Journal journal;
+		// Set while the journal is being replayed, so that the replayed edits are not recorded again.
+		bool replaying;
+		// Set while a copy of this save is being saved on another thread; the journal is not written meanwhile.
+		bool savingCopy;
+		// The end of the journal when the copy being saved on another thread was taken.
+		Journal::Mark copyMark;
+		// Called after each edit is recorded in the journal, if set, e.g. to schedule saving it.
+		std::function<void()> editListener;
+
+		// Record the given edit in the journal unless it is being replayed from it.
+		void record(QJsonObject &&edit) {
+			if(!replaying) {
+				journal.record(edit);
+				if(editListener) {
+					editListener();
+				}
+			}
+		}
+
+		// Returns the name to record for the given list of chapters.
+		static QString chapter_list_name(ChapterList const cl) {
+			return cl == ChapterList::liked ? u"Liked Chapters"_qs : u"Loved Chapters"_qs;
+		}
+
+		// Returns the ID by which a record of the journal refers to the entry at the given index,
+		// so that the record still applies to the same entry once the entries before it are sorted or deleted.
+		qint64 record_id(EntryVector::size_type const index) const {
+			return static_cast<qint64>(entries.get_id(index));
+		}
+
+		// Apply the given edit recorded in the journal.
+		void apply(QJsonObject const &edit) {
+			QString const op = edit[u"Op"_qs].toString();
+			// Edits refer to entries by ID.
+			auto const index = entries.find_id(static_cast<EntryId>(edit[u"ID"_qs].toInteger()));
+			if(op == u"Add"_qs) {
+				Entry entry = entries.create_entry();
+				entry.from_json(edit[u"Entry"_qs].toObject());
+				entry.set_id(static_cast<EntryId>(std::max(edit[u"ID"_qs].toInteger(), qint64(0))));
+				add_entry(std::move(entry));
+			}
+			else if(index >= entries.size()) {
+				qWarning() << u"Skipped a journal record for an entry that does not exist."_qs;
+			}
+			else if(op == u"Duplicate"_qs) {
+				duplicate_entry(index);
+			}
+			else if(op == u"Delete"_qs) {
+				delete_entry(index);
+			}
+			else if(op == u"Set"_qs) {
+				if(FieldKey const key = FieldKeys::find_standard(edit[u"Field"_qs].toString()); key >= 0) {
+					set_field(index, static_cast<Field>(key), edit[u"Value"_qs].toString());
+				}
+			}
+			else if(op == u"Import Chapters"_qs) {
+				ChapterList const cl =
+						edit[u"List"_qs].toString() == chapter_list_name(ChapterList::loved) ? ChapterList::loved : ChapterList::liked;
+				import_chapters(index, edit[u"Chapters"_qs].toString(), cl);
+			}
+			else if(op == u"Add Chapter"_qs || op == u"Delete Chapter"_qs) {
+				ChapterList const cl =
+						edit[u"List"_qs].toString() == chapter_list_name(ChapterList::loved) ? ChapterList::loved : ChapterList::liked;
+				if(op == u"Add Chapter"_qs) {
+					add_chapter(index, edit[u"Chapter"_qs].toString(), cl);
+				}
+				else {
+					delete_chapter(index, edit[u"Chapter"_qs].toString(), cl);
+				}
+			}
+		}
+
+		// Use the save file at the given path, in the binary save format if the given flag is set, from now on,
+		// along with the journal that goes with it.
+		void set_save_file(QString const &path, bool const binary) {
+			savePath = path;
+			binaryFile = binary;
+			journal.set_path(Journal::path_for(savePath));
+		}
+
+		// Redo the edits saved to the journal since the save file was last written.
+		bool replay_journal() {
+			replaying = true;
+			bool const replayed = journal.replay(generation, [this](QJsonObject const &edit) {
+				apply(edit);
+			});
+			replaying = false;
+
+			return replayed;
+		}
 
 		public:
 		// Default constructor that initializes id using the current time and the other elements to their default states.
 		Save():
 				id(u"OMM_"_qs), countTotal(0), countsByType(u"Counts by Type"_qs), countsByLanguage(u"Counts by Language"_qs),
-				countsByProgress(u"Counts by Progress"_qs), entries() {
+				countsByProgress(u"Counts by Progress"_qs), entries(), generation(0), savePath(u"omm.json"_qs),
+				binaryFile(false), journal(Journal::path_for(savePath)), replaying(false), savingCopy(false), copyMark(),
+				editListener() {
 			// Initialize id.
 			auto tn = std::chrono::system_clock::now().time_since_epoch();
 			struct std::tm tm {};
@@ -75,8 +187,44 @@ namespace omm {
 			}
 		}
 
+		// Adjust the counts for the given entry by the given amount (1 when it is added, -1 when it is removed).
+		void count_entry(Entry const &entry, int const delta) {
+			// Adjust the corresponding type or unspecified if not applicable.
+			if(entry.at(Field::Type).isEmpty()) {
+				countsByType[u"Unspecified"_qs] += delta;
+			}
+			else {
+				countsByType[entry.at(Field::Type)] += delta;
+			}
+
+			// Adjust the corresponding language or unspecified if not applicable.
+			if(entry.at(Field::Language).isEmpty()) {
+				countsByLanguage[u"Unspecified"_qs] += delta;
+			}
+			else {
+				countsByLanguage[entry.at(Field::Language)] += delta;
+			}
+
+			// Adjust the corresponding progress.
+			if(entry.at(Field::Progress).isEmpty()) {
+				countsByProgress[u"Not Started"_qs] += delta;
+			}
+			else if(entry.at(Field::Progress) == u"Finished"_qs) {
+				countsByProgress[u"Finished"_qs] += delta;
+			}
+			else {
+				countsByProgress[u"In Progress"_qs] += delta;
+			}
+		}
+
+		// Returns true if the given field affects the counts.
+		static bool is_counted(Field const field) noexcept {
+			return field == Field::Type || field == Field::Language || field == Field::Progress;
+		}
+
 		// Recalculate all counts.
 		void re_count() {
+			OMM_PROFILE_SCOPE(ReCount, entries.size());
 			// Reset all counts.
 			for(auto &count: countsByType) {
 				count.second = 0;
@@ -90,46 +238,62 @@ namespace omm {
 
 			// Redo all counts.
 			countTotal = entries.size();
-			for(auto const &entry: entries) {
-				try {
-					// Increment the corresponding type or unspecified if not applicable.
-					if(entry.at(u"Type"_qs).isEmpty()) {
-						++countsByType[u"Unspecified"_qs];
-					}
-					else {
-						++countsByType[entry.at(u"Type"_qs)];
-					}
+			for(auto const &entry: std::as_const(entries)) {
+				count_entry(entry, 1);
+			}
+		}
 
-					// Increment the corresponding language or unspecified if not applicable.
-					if(entry.at(u"Language"_qs).isEmpty()) {
-						++countsByLanguage[u"Unspecified"_qs];
-					}
-					else {
-						++countsByLanguage[entry.at(u"Language"_qs)];
-					}
+		// Recalculate all counts; returns true if they were already right.
+		bool verify_counts() {
+			Counts const byType(countsByType), byLanguage(countsByLanguage), byProgress(countsByProgress);
+			auto const total = countTotal;
+			re_count();
+			return total == countTotal && byType == countsByType && byLanguage == countsByLanguage &&
+					byProgress == countsByProgress;
+		}
 
-					// Increment the corresponding progress.
-					if(entry.at(u"Progress"_qs).isEmpty()) {
-						++countsByProgress[u"Not Started"_qs];
-					}
-					else if(entry.at(u"Progress"_qs) == u"Finished"_qs) {
-						++countsByProgress[u"Finished"_qs];
-					}
-					else {
-						++countsByProgress[u"In Progress"_qs];
-					}
-				}
-				catch(std::exception const &e) {
-					qDebug() << u"This exception should not occur:"_qs << e.what();
-				}
+		// Check that the counts kept up to date by each edit match a full recount (debug builds only).
+		void check_counts() {
+#ifdef QT_DEBUG
+			if(!verify_counts()) {
+				qWarning() << u"The counts kept up to date by each edit do not match a full recount."_qs;
+				Q_ASSERT(false);
 			}
+#endif
 		}
 
 		// Refresh the counts and entries.
-		void refresh() {
-			// Recalculate the counts and re-sort the entries.
-			re_count();
-			entries.sort();
+		// Returns the previous index of the entry now at each index.
+		// Sorting changes no entry, and journal records refer to entries by ID, so it is not journaled.
+		std::vector<EntryVector::size_type> refresh() {
+			auto sorted = prepare_refresh();
+			apply_refresh(sorted);
+			return sorted;
+		}
+
+		// Do the work of refresh() that takes time in proportion to the number of entries, without changing their order
+		// yet, so that it can run on another thread (see Entries::prepare_sort()), advancing the given progress, if any.
+		// Returns what to pass to apply_refresh(), or an empty list if the progress was cancelled.
+		std::vector<EntryVector::size_type> prepare_refresh(Progress *const progress = nullptr) {
+			// The counts are kept up to date by each edit, so only re-sort the entries.
+			check_counts();
+			return entries.prepare_sort(progress);
+		}
+
+		// Finish refresh() after prepare_refresh() by putting the entries in their new order.
+		void apply_refresh(std::vector<EntryVector::size_type> const &sorted) {
+			entries.apply_sort(sorted);
+		}
+
+		// Set the function to call after each edit recorded in the journal (e.g. to schedule saving it), or nullptr for
+		// none; every edit of this save is journaled, so nothing else needs to track which entries changed.
+		void set_edit_listener(std::function<void()> listener) {
+			editListener = std::move(listener);
+		}
+
+		// Get the path that this save was last saved to or loaded from.
+		QString const &get_save_path() const noexcept {
+			return savePath;
 		}
 
 		// Getter/setter for the ID of this save.
@@ -157,14 +321,160 @@ namespace omm {
 			return countsByProgress[key];
 		}
 
-		// Wrapper for entries.add_entry().
+		// Getter for the counts by type.
+		Counts const &get_countsByType() const noexcept {
+			return countsByType;
+		}
+
+		// Getter for the counts by language.
+		Counts const &get_countsByLanguage() const noexcept {
+			return countsByLanguage;
+		}
+
+		// Getter for the counts by progress.
+		Counts const &get_countsByProgress() const noexcept {
+			return countsByProgress;
+		}
+
+		// Wrapper for entries.set_thread_count().
+		void set_thread_count(unsigned const count) noexcept {
+			entries.set_thread_count(count);
+		}
+
+		// Wrapper for entries.create_entry().
+		Entry create_entry() {
+			return entries.create_entry();
+		}
+
+		// Wrapper for entries.size().
+		EntryVector::size_type size() const noexcept {
+			return entries.size();
+		}
+
+		// Wrapper for entries.at() (const); edit entries through the functions below so that the counts stay up to date.
+		Entry const &get_entry(EntryVector::size_type const index) const {
+			return entries.at(index);
+		}
+
+		// Wrapper for entries.search(); returns the indices of the entries found, best match first.
+		std::vector<EntryVector::size_type> search(QString const &query, std::size_t const limit = 100) const {
+			return entries.search(query, limit);
+		}
+
+		// Wrapper for entries.filter(); returns the indices of the entries that match the given filter,
+		// e.g. {{u"Web Novel"_qs}, {u"Korean"_qs}, {u"Finished"_qs}, {u"9"_qs, u"10"_qs}, {}}.
+		std::vector<EntryVector::size_type> filter(FacetFilter const &filter) const {
+			return entries.filter(filter);
+		}
+
+		// Wrapper for entries.facet_counts(); the counts of the given facet for the entries that match the given filter,
+		// which match the nonzero counts of this save when the filter is empty.
+		std::map<QString, int> facet_counts(Facet const facet, FacetFilter const &filter = FacetFilter()) const {
+			return entries.facet_counts(facet, filter);
+		}
+
+		// Wrapper for entries.find(); returns size() if there is no such entry.
+		EntryVector::size_type find_entry(Entry const &entry) const {
+			return entries.find(entry);
+		}
+
+		// Wrapper for entries.find_id(); returns size() if there is no entry with the given ID.
+		EntryVector::size_type find_id(EntryId const entryId) const {
+			return entries.find_id(entryId);
+		}
+
+		// Wrapper for entries.contains().
+		bool contains_entry(Entry const &entry) const {
+			return entries.contains(entry);
+		}
+
+		// Wrapper for entries.add_entry() that also updates the counts.
 		void add_entry(Entry &&entry) {
+			count_entry(entry, 1);
+			++countTotal;
 			entries.add_entry(std::move(entry));
+			if(!replaying) {
+				// Record the entry with the ID it was given, so that replaying the journal gives it the same one;
+				// the ID is kept apart from the fields of the entry, as in the save.
+				QJsonObject entryObject;
+				entries.at(entries.size() - 1).to_json(entryObject);
+				record(QJsonObject{{u"Op"_qs, u"Add"_qs}, {u"ID"_qs, record_id(entries.size() - 1)},
+						{u"Entry"_qs, entryObject}});
+			}
+		}
+
+		// Wrapper for entries.duplicate_entry() that also updates the counts.
+		void duplicate_entry(EntryVector::size_type const index) {
+			record(QJsonObject{{u"Op"_qs, u"Duplicate"_qs}, {u"ID"_qs, record_id(index)}});
+			count_entry(entries.at(index), 1);
+			++countTotal;
+			entries.duplicate_entry(index);
+		}
+
+		// Wrapper for entries.duplicate_entry() that also updates the counts.
+		void duplicate_entry(Entry const &entry) {
+			if(auto const index = entries.find(entry); index != entries.size()) {
+				duplicate_entry(index);
+			}
+		}
+
+		// Wrapper for entries.delete_entry() that also updates the counts.
+		void delete_entry(EntryVector::size_type const index) {
+			record(QJsonObject{{u"Op"_qs, u"Delete"_qs}, {u"ID"_qs, record_id(index)}});
+			count_entry(entries.at(index), -1);
+			--countTotal;
+			entries.delete_entry(index);
+		}
+
+		// Wrapper for entries.delete_entry() that also updates the counts.
+		void delete_entry(Entry const &entry) {
+			if(auto const index = entries.find(entry); index != entries.size()) {
+				delete_entry(index);
+			}
+		}
+
+		// Set the given field of the entry at the given index, updating the counts if the field affects them.
+		void set_field(EntryVector::size_type const index, Field const field, QString value) {
+			record(QJsonObject{{u"Op"_qs, u"Set"_qs}, {u"ID"_qs, record_id(index)},
+					{u"Field"_qs, FieldKeys::name(field)}, {u"Value"_qs, value}});
+			Entry const &entry = entries.at(index);
+			if(is_counted(field)) {
+				count_entry(entry, -1);
+				entries.set_field(index, field, std::move(value));
+				count_entry(entry, 1);
+			}
+			else {
+				entries.set_field(index, field, std::move(value));
+			}
+		}
+
+		// Add the given chapter to the specified list of chapters of the entry at the given index.
+		void add_chapter(EntryVector::size_type const index, QString const &chapter, ChapterList const cl) {
+			record(QJsonObject{{u"Op"_qs, u"Add Chapter"_qs}, {u"ID"_qs, record_id(index)},
+					{u"List"_qs, chapter_list_name(cl)}, {u"Chapter"_qs, chapter}});
+			entries.add_chapter(index, chapter, cl);
+		}
+
+		// Add all the chapters in the given text (e.g. "1~50, 52") to the specified list of chapters of the entry at the
+		// given index at once; recorded as a single edit.
+		void import_chapters(EntryVector::size_type const index, QString const &text, ChapterList const cl) {
+			record(QJsonObject{{u"Op"_qs, u"Import Chapters"_qs}, {u"ID"_qs, record_id(index)},
+					{u"List"_qs, chapter_list_name(cl)}, {u"Chapters"_qs, text}});
+			entries.import_chapters(index, text, cl);
+		}
+
+		// Remove the given chapter from the specified list of chapters of the entry at the given index.
+		void delete_chapter(EntryVector::size_type const index, QString const &chapter, ChapterList const cl) {
+			record(QJsonObject{{u"Op"_qs, u"Delete Chapter"_qs}, {u"ID"_qs, record_id(index)},
+					{u"List"_qs, chapter_list_name(cl)}, {u"Chapter"_qs, chapter}});
+			entries.delete_chapter(index, chapter, cl);
 		}
 
 		// Serialize this save in JSON format.
 		void to_json(QJsonObject &json) const {
+			json[u"_Generation"_qs] = generation;
 			json[u"_ID"_qs] = id;
+			json[u"_Next Entry ID"_qs] = static_cast<qint64>(entries.get_next_id());
 			json[u"Count Total"_qs] = static_cast<qint64>(countTotal);
 			countsByType.to_json(json);
 			countsByLanguage.to_json(json);
@@ -172,19 +482,112 @@ namespace omm {
 			entries.to_json(json);
 		}
 
+		// Serialize this save with the given writer, in the same format as to_json() with QJsonDocument::toJson(),
+		// advancing the given progress, if any, by one for each entry; returns false if it fails or is cancelled.
+		bool to_writer(JsonWriter &writer, Progress *const progress = nullptr) const {
+			// The members are written in the same order as QJsonObject, which keeps them sorted by key.
+			writer.begin_object();
+			writer.member(u"Count Total"_qs, static_cast<qint64>(countTotal));
+			countsByLanguage.to_writer(writer);
+			countsByProgress.to_writer(writer);
+			countsByType.to_writer(writer);
+			if(!entries.to_writer(writer, progress)) {
+				return false;
+			}
+			entries.ids_to_writer(writer);
+			writer.member(u"_Generation"_qs, generation);
+			writer.member(u"_ID"_qs, id);
+			writer.member(u"_Next Entry ID"_qs, static_cast<qint64>(entries.get_next_id()));
+			writer.end_object();
+
+			return writer.flush();
+		}
+
 		// Reconstruct this save from JSON data.
 		void from_json(const QJsonObject &json) {
 			id = json[u"_ID"_qs].toString();
+			generation = json[u"_Generation"_qs].toInteger();
 			countTotal = static_cast<EntryVector::size_type>(json[u"Count Total"_qs].toInteger());
 			countsByType.from_json(json);
 			countsByLanguage.from_json(json);
 			countsByProgress.from_json(json);
 			entries.from_json(json);
+			entries.reserve_ids(static_cast<EntryId>(json[u"_Next Entry ID"_qs].toInteger()));
+			// Make sure that the counts match the entries, since edits only adjust them from here on.
+			re_count();
+		}
+
+		// Reconstruct this save from the JSON data that the given reader is at, without building a document,
+		// advancing the given progress, if any, by one for each entry; returns false if it fails or is cancelled.
+		bool from_reader(JsonReader &reader, Progress *const progress = nullptr) {
+			countsByType.clear();
+			countsByLanguage.clear();
+			countsByProgress.clear();
+			if(!reader.enter_object()) {
+				return false;
+			}
+
+			QString key;
+			// The next entry ID comes after the entries, so it is applied once they are read.
+			EntryId nextEntryId = 0;
+			while(reader.next_key(key)) {
+				if(key == u"_ID"_qs && reader.peek_type() == JsonType::String) {
+					reader.read_string(id);
+				}
+				else if(qint64 value; key == u"_Generation"_qs && reader.peek_type() == JsonType::Number) {
+					if(reader.read_integer(value)) {
+						generation = value;
+					}
+				}
+				else if(qint64 next; key == u"_Next Entry ID"_qs && reader.peek_type() == JsonType::Number) {
+					if(reader.read_integer(next)) {
+						nextEntryId = static_cast<EntryId>(next);
+					}
+				}
+				else if(qint64 total; key == u"Count Total"_qs && reader.peek_type() == JsonType::Number) {
+					if(reader.read_integer(total)) {
+						countTotal = static_cast<EntryVector::size_type>(total);
+					}
+				}
+				else if(key == countsByType.get_name()) {
+					countsByType.from_reader(reader);
+				}
+				else if(key == countsByLanguage.get_name()) {
+					countsByLanguage.from_reader(reader);
+				}
+				else if(key == countsByProgress.get_name()) {
+					countsByProgress.from_reader(reader);
+				}
+				else if(key == entries.get_name()) {
+					if(!entries.from_reader(reader, progress) && progress && progress->is_cancelled()) {
+						return false;
+					}
+				}
+				else if(key == entries.get_ids_name()) {
+					entries.ids_from_reader(reader);
+				}
+				else {
+					reader.skip_value();
+				}
+			}
+			entries.reserve_ids(nextEntryId);
+			// Make sure that the counts match the entries, since edits only adjust them from here on.
+			re_count();
+
+			return !reader.has_error();
 		}
 
 		// Save this save to a file.
-		bool save() {
-			QFile file(u"omm.json"_qs);
+		// The entries are streamed into a temporary file, which then replaces the save file only once fully written,
+		// so that a failure midway leaves the previous save intact.
+		// This is a full save that folds the journal back into the save file, so the journal is removed afterwards;
+		// until then, the journal belongs to the previous generation and is ignored when loading.
+		// The given progress, if any, is advanced by one for each entry written, and cancelling it leaves the file as is.
+		// The entries are compacted first, dropping the empty slots left by deleted entries.
+		bool save(QString const &path = u"omm.json"_qs, Progress *const progress = nullptr) {
+			OMM_PROFILE_SCOPE(Save, entries.size());
+			entries.compact();
+			QSaveFile file(path);
 
 			if(!file.open(QIODevice::WriteOnly)) {
 				qWarning() << u"Could not open save file."_qs;
@@ -192,16 +595,104 @@ namespace omm {
 				return false;
 			}
 
-			QJsonObject saveObject;
-			to_json(saveObject);
-			file.write(QJsonDocument(saveObject).toJson());
+			if(progress) {
+				progress->set_total(static_cast<qint64>(entries.size()));
+			}
+			++generation;
+			JsonWriter writer(file);
+			if(!to_writer(writer, progress) || !file.commit()) {
+				if(!progress || !progress->is_cancelled()) {
+					qWarning() << u"Could not write save file."_qs;
+				}
+				file.cancelWriting();
+				--generation;
+
+				return false;
+			}
+
+			set_save_file(path, false);
+			journal.clear();
 
 			return true;
 		}
 
-		// Load a save from a file.
-		bool load() {
-			QFile file(u"omm.json"_qs);
+		// Returns true if there are edits that are not in the save file or the journal file yet.
+		bool has_unsaved_changes() const noexcept {
+			return journal.has_pending();
+		}
+
+		// Returns true if save_changes() would do a full save rather than append to the journal.
+		bool needs_full_save() const {
+			return journal.size() >= Journal::compactThreshold || !QFile::exists(savePath);
+		}
+
+		// Save only the edits made since the last call by appending them to the journal,
+		// or do a full save instead if there is no save file yet or once the journal has grown long enough.
+		// While a copy is being saved on another thread, the edits are kept until it is done.
+		bool save_changes() {
+			if(savingCopy) {
+				return true;
+			}
+			if(needs_full_save()) {
+				return save_file();
+			}
+
+			return journal.flush(generation);
+		}
+
+		// Append the edits made since the last call to the journal, without ever doing a full save,
+		// for callers that do full saves on another thread instead (see needs_full_save() and begin_copy_save()).
+		// While a copy is being saved on another thread, the edits are kept until it is done.
+		bool save_journal() {
+			return savingCopy || journal.flush(generation);
+		}
+
+		// Do a full save to the save file, in the format that it is in, advancing the given progress, if any, while
+		// saving in JSON format.
+		bool save_file(Progress *const progress = nullptr) {
+			return binaryFile ? save_binary(savePath) : save(savePath, progress);
+		}
+
+		// Fold the journal back into the save file if it has any edits (e.g. on exit).
+		bool compact() {
+			return savingCopy || journal.size() == 0 || save_file();
+		}
+
+		// Start saving a copy of this save on another thread, so that edits can go on meanwhile: the journal is kept
+		// from being written until end_copy_save() is called with the result.
+		// The copy is taken with copy_for_save() and saved with save_file().
+		void begin_copy_save() {
+			savingCopy = true;
+			copyMark = journal.mark();
+		}
+
+		// Returns the copy of this save to save after begin_copy_save().
+		// Taking the copy copies every entry but not its field values (see the copy constructor of Entries), so it
+		// takes time in proportion to the number of entries; it may be taken on another thread, as long as this save
+		// is not edited until it is.
+		std::shared_ptr<Save> copy_for_save() const {
+			auto copy = std::make_shared<Save>(*this);
+			copy->editListener = nullptr;
+			return copy;
+		}
+
+		// Take over the result of saving the copy on another thread, given only if it was saved: if so, the edits
+		// recorded before begin_copy_save() are now in the save file, so only the edits made since then are left in
+		// the journal.
+		void end_copy_save(Save const *const saved) {
+			savingCopy = false;
+			if(saved) {
+				generation = saved->generation;
+				set_save_file(saved->savePath, saved->binaryFile);
+				journal.drop_through(copyMark);
+			}
+		}
+
+		// Load a save from a file, advancing the given progress, if any, by one for each entry read;
+		// cancelling it stops the load, leaving this save incomplete.
+		bool load(QString const &path = u"omm.json"_qs, Progress *const progress = nullptr) {
+			OMM_PROFILE_SCOPE(Load, 0);
+			QFile file(path);
 
 			if(!file.open(QIODevice::ReadOnly)) {
 				qWarning() << u"Could not open save file."_qs;
@@ -209,11 +700,89 @@ namespace omm {
 				return false;
 			}
 
-			QByteArray data = file.readAll();
-			QJsonDocument loadDocument(QJsonDocument::fromJson(data));
-			from_json(loadDocument.object());
+			// Stream the entries straight out of the file instead of reading it whole into a document first.
+			JsonReader reader(file);
+			if(!from_reader(reader, progress)) {
+				if(!progress || !progress->is_cancelled()) {
+					qWarning() << u"Could not parse save file."_qs;
+				}
+
+				return false;
+			}
+			OMM_PROFILE_ITEMS(entries.size());
+
+			// Redo the edits saved to the journal since the save file was written.
+			set_save_file(path, false);
+
+			return replay_journal();
+		}
+
+		// Save this save to a file in the binary save format, replacing the file only once fully written.
+		// Like save(), this is a full save that folds the journal back into the save file.
+		bool save_binary(QString const &path = u"omm.bin"_qs) {
+			OMM_PROFILE_SCOPE(Save, entries.size());
+			QSaveFile file(path);
+
+			if(!file.open(QIODevice::WriteOnly)) {
+				qWarning() << u"Could not open binary save file."_qs;
+
+				return false;
+			}
+
+			BinaryBuilder builder;
+			entries.to_binary(builder);
+			builder.add_counts(countsByType);
+			builder.add_counts(countsByLanguage);
+			builder.add_counts(countsByProgress);
+			if(!builder.write(file, id, static_cast<quint64>(countTotal), entries.get_next_id(), generation + 1) ||
+					!file.commit()) {
+				qWarning() << u"Could not write binary save file."_qs;
+
+				return false;
+			}
+
+			++generation;
+			set_save_file(path, true);
+			journal.clear();
 
 			return true;
 		}
+
+		// Load a save from a file in the binary save format.
+		// The file is memory-mapped and each entry is only decoded once it is accessed;
+		// the counts are read as stored, since they were kept up to date when the file was written.
+		bool load_binary(QString const &path = u"omm.bin"_qs) {
+			OMM_PROFILE_SCOPE(Load, 0);
+			auto image = BinaryImage::open(path);
+			if(!image) {
+				qWarning() << u"Could not open binary save file."_qs;
+
+				return false;
+			}
+
+			id = image->id();
+			generation = image->generation();
+			countTotal = static_cast<EntryVector::size_type>(image->count_total());
+			image->decode_counts(countsByType, countsByLanguage, countsByProgress);
+			entries.from_binary(std::move(image));
+			OMM_PROFILE_ITEMS(entries.size());
+
+			// Redo the edits saved to the journal since the save file was written, as load() does.
+			set_save_file(path, true);
+
+			return replay_journal();
+		}
+
+		// Convert the JSON save at the given path to the binary save format.
+		static bool json_to_binary(QString const &jsonPath, QString const &binaryPath) {
+			Save save;
+			return save.load(jsonPath) && save.save_binary(binaryPath);
+		}
+
+		// Convert the binary save at the given path to JSON.
+		static bool binary_to_json(QString const &binaryPath, QString const &jsonPath) {
+			Save save;
+			return save.load_binary(binaryPath) && save.save(jsonPath);
+		}
 	};
 } // namespace omm
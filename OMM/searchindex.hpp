@@ -0,0 +1,287 @@
+#pragma once
+
+#include <QString>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "entry.hpp"
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The fields covered by searching, from the one whose matches rank highest to the one whose matches rank lowest.
+	inline constexpr std::array<Field, 5> searchFields{
+			Field::Title, Field::OriginalTitle, Field::FranchiseSeries, Field::Author, Field::Notes};
+
+	// The class that indexes the searchable fields of a list of entries for full-text search.
+	// Every run of one to three characters (UTF-16 code units) of the case-folded fields is an n-gram, and each n-gram
+	// lists the entries that contain it, so that partial words in any script can be found without scanning the entries.
+	class SearchIndex {
+		private:
+		// The number that identifies an entry within the index regardless of its position in the list.
+		using Doc = quint32;
+		// An n-gram packed into a number: its code units in the low 48 bits and its length above them.
+		using Gram = quint64;
+		// A posting: the document in the high bits, then 8 bits for the set of search fields that start with the n-gram,
+		// and 8 bits for the set of search fields that contain it.
+		using Posting = quint64;
+
+		// The longest n-grams indexed; queries this long or shorter are answered from the index alone.
+		static constexpr qsizetype gramLength = 3;
+
+		// The postings of each n-gram, sorted by document.
+		std::unordered_map<Gram, std::vector<Posting>> postings;
+		// The case-folded searchable fields of each document, in the order of searchFields.
+		std::vector<std::array<QString, searchFields.size()>> texts;
+		// The document of the entry at each position.
+		std::vector<Doc> docs;
+		// The position of the entry of each document.
+		std::vector<std::size_t> positions;
+		// The documents of removed entries, which are reused for new ones.
+		std::vector<Doc> freeDocs;
+
+		// Returns the form of the given text used for matching, which ignores case and compatibility differences
+		// (e.g. full-width and half-width forms).
+		static QString fold(QString const &text) {
+			return text.normalized(QString::NormalizationForm_KC).toCaseFolded();
+		}
+
+		// Returns the n-gram of the given length starting at the given code unit.
+		static Gram gram(char16_t const *const it, qsizetype const length) noexcept {
+			Gram g = Gram(length) << 48;
+			for(qsizetype a = 0; a < length; ++a) {
+				g |= Gram(it[a]) << (16 * a);
+			}
+			return g;
+		}
+
+		// Returns every n-gram of the searchable fields of the given document along with the fields starting with it
+		// (the high 8 bits) and containing it (the low 8 bits).
+		std::vector<std::pair<Gram, quint16>> grams_of(Doc const doc) const {
+			std::vector<std::pair<Gram, quint16>> grams;
+			for(std::size_t f = 0; f < searchFields.size(); ++f) {
+				QString const &text = texts[doc][f];
+				auto const units = reinterpret_cast<char16_t const *>(text.utf16());
+				for(qsizetype a = 0; a < text.size(); ++a) {
+					for(qsizetype length = 1; length <= gramLength && a + length <= text.size(); ++length) {
+						grams.emplace_back(gram(units + a, length), static_cast<quint16>((a == 0 ? 0x101u : 1u) << f));
+					}
+				}
+			}
+
+			// Merge the fields of each n-gram.
+			std::sort(grams.begin(), grams.end());
+			auto merged = grams.begin();
+			for(auto gi = grams.begin(); gi != grams.end(); ++gi) {
+				if(gi != grams.begin() && gi->first == std::prev(merged)->first) {
+					std::prev(merged)->second |= gi->second;
+				}
+				else {
+					*merged++ = *gi;
+				}
+			}
+			grams.erase(merged, grams.end());
+			return grams;
+		}
+
+		// Add the postings of the given document.
+		void add_postings(Doc const doc) {
+			for(auto const &[g, fields]: grams_of(doc)) {
+				auto &list = postings[g];
+				Posting const posting = Posting(doc) << 16 | fields;
+				if(list.empty() || list.back() < posting) {
+					list.push_back(posting);
+				}
+				else {
+					list.insert(std::lower_bound(list.begin(), list.end(), posting), posting);
+				}
+			}
+		}
+
+		// Remove the postings of the given document.
+		void remove_postings(Doc const doc) {
+			for(auto const &a: grams_of(doc)) {
+				auto const pi = postings.find(a.first);
+				if(pi == postings.end()) {
+					continue;
+				}
+
+				auto &list = pi->second;
+				auto const li = std::lower_bound(list.begin(), list.end(), Posting(doc) << 16);
+				if(li != list.end() && (*li >> 16) == doc) {
+					list.erase(li);
+				}
+				if(list.empty()) {
+					postings.erase(pi);
+				}
+			}
+		}
+
+		// Fold the searchable fields of the given entry into the texts of the given document.
+		void set_texts(Doc const doc, Entry const &entry) {
+			for(std::size_t f = 0; f < searchFields.size(); ++f) {
+				texts[doc][f] = fold(entry.at(searchFields[f]));
+			}
+		}
+
+		// Update the positions of the documents of the entries from the given position onwards.
+		void renumber(std::size_t const from) {
+			for(std::size_t a = from; a < docs.size(); ++a) {
+				positions[docs[a]] = a;
+			}
+		}
+
+		public:
+		// Remove every entry from the index.
+		void clear() noexcept {
+			postings.clear();
+			texts.clear();
+			docs.clear();
+			positions.clear();
+			freeDocs.clear();
+		}
+
+		// Index the given list of entries from scratch; any list with size() and at() will do.
+		template<typename List>
+		void build(List const &entries) {
+			clear();
+			texts.resize(entries.size());
+			docs.resize(entries.size());
+			positions.resize(entries.size());
+			for(std::size_t a = 0; a < entries.size(); ++a) {
+				docs[a] = static_cast<Doc>(a);
+				positions[a] = a;
+				set_texts(static_cast<Doc>(a), entries.at(a));
+				add_postings(static_cast<Doc>(a));
+			}
+		}
+
+		// Index the given entry, which is inserted into the list at the given position.
+		void insert(std::size_t const position, Entry const &entry) {
+			Doc doc;
+			if(freeDocs.empty()) {
+				doc = static_cast<Doc>(texts.size());
+				texts.emplace_back();
+				positions.emplace_back();
+			}
+			else {
+				doc = freeDocs.back();
+				freeDocs.pop_back();
+			}
+
+			set_texts(doc, entry);
+			add_postings(doc);
+			docs.insert(docs.begin() + static_cast<std::ptrdiff_t>(position), doc);
+			renumber(position);
+		}
+
+		// Stop indexing the entry at the given position, which is removed from the list.
+		void erase(std::size_t const position) {
+			Doc const doc = docs[position];
+			remove_postings(doc);
+			texts[doc] = {};
+			freeDocs.push_back(doc);
+			docs.erase(docs.begin() + static_cast<std::ptrdiff_t>(position));
+			renumber(position);
+		}
+
+		// Index the given entry again, since its searchable fields changed.
+		void update(std::size_t const position, Entry const &entry) {
+			Doc const doc = docs[position];
+			remove_postings(doc);
+			set_texts(doc, entry);
+			add_postings(doc);
+		}
+
+		// Follow the entries to their new positions, where the entry now at each position was at order[position].
+		void permute(std::vector<std::size_t> const &order) {
+			std::vector<Doc> permuted(order.size());
+			for(std::size_t a = 0; a < order.size(); ++a) {
+				permuted[a] = docs[order[a]];
+			}
+			docs.swap(permuted);
+			renumber(0);
+		}
+
+		// Returns the positions of up to the given number of entries that contain the given text in a searchable field,
+		// best match first: matches in an earlier field of searchFields rank higher, a match at the start of a field
+		// ranks higher than one elsewhere in the same field, and equal matches keep the order of the list.
+		std::vector<std::size_t> search(QString const &query, std::size_t const limit) const {
+			QString const q = fold(query);
+			if(q.isEmpty() || limit == 0) {
+				return {};
+			}
+
+			// Gather the postings of the n-grams of the query, all of which a matching entry must contain;
+			// a query no longer than an n-gram is itself one.
+			auto const units = reinterpret_cast<char16_t const *>(q.utf16());
+			std::vector<std::vector<Posting> const *> lists;
+			for(qsizetype a = 0; a + std::min(q.size(), gramLength) <= q.size(); ++a) {
+				auto const pi = postings.find(gram(units + a, std::min(q.size(), gramLength)));
+				if(pi == postings.end()) {
+					return {};
+				}
+				lists.push_back(&pi->second);
+			}
+
+			// Intersect the postings, starting from the shortest list.
+			std::sort(lists.begin(), lists.end(), [](auto const l, auto const r) {
+				return l->size() < r->size();
+			});
+			std::vector<Posting> candidates(*lists.front());
+			for(auto li = std::next(lists.cbegin()); li != lists.cend() && !candidates.empty(); ++li) {
+				auto out = candidates.begin();
+				auto pi = (*li)->cbegin();
+				for(auto const candidate: candidates) {
+					pi = std::lower_bound(pi, (*li)->cend(), candidate & ~Posting(0xFFFF));
+					if(pi != (*li)->cend() && (*pi >> 16) == (candidate >> 16)) {
+						*out++ = candidate;
+					}
+				}
+				candidates.erase(out, candidates.end());
+			}
+
+			// Score the candidates; a query no longer than an n-gram is scored from its postings alone,
+			// while longer ones are checked against the texts since their n-grams may be apart.
+			std::vector<std::pair<quint32, std::size_t>> results;
+			results.reserve(candidates.size());
+			for(auto const candidate: candidates) {
+				auto const doc = static_cast<Doc>(candidate >> 16);
+				quint32 score = 0;
+				for(std::size_t f = 0; f < searchFields.size(); ++f) {
+					bool starts, contains;
+					if(q.size() <= gramLength) {
+						starts = candidate >> (8 + f) & 1;
+						contains = candidate >> f & 1;
+					}
+					else {
+						QString const &text = texts[doc][f];
+						starts = text.startsWith(q);
+						contains = starts || text.contains(q);
+					}
+					if(contains) {
+						score |= (starts ? 2u : 1u) << (2 * (searchFields.size() - f));
+					}
+				}
+				if(score) {
+					results.emplace_back(score, positions[doc]);
+				}
+			}
+
+			// Rank the results.
+			auto const better = [](auto const &l, auto const &r) {
+				return l.first != r.first ? l.first > r.first : l.second < r.second;
+			};
+			auto const count = std::min(limit, results.size());
+			std::partial_sort(results.begin(), results.begin() + static_cast<std::ptrdiff_t>(count), results.end(), better);
+			std::vector<std::size_t> ranked(count);
+			for(std::size_t a = 0; a < count; ++a) {
+				ranked[a] = results[a].second;
+			}
+			return ranked;
+		}
+	};
+} // namespace omm
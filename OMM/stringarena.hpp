@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QString>
+#include <QStringDecoder>
+#include <QtGlobal>
+#include <utility>
+#include <vector>
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// Returns true if the given string is a view of data that it does not own, such as a buffer of a StringArena;
+	// QString reports such a string as having no capacity of its own.
+	inline bool is_view(QString const &string) noexcept {
+		return !string.isEmpty() && string.capacity() == 0;
+	}
+
+	// Give the given string memory of its own if it is a view of data that it does not own (see is_view()).
+	inline void own(QString &string) {
+		if(is_view(string)) {
+			string = QString(string.constData(), string.size());
+		}
+	}
+
+	// The class that keeps many short strings in a few large buffers, so that loading a library allocates once per
+	// buffer rather than once per field value.
+	// Each buffer is an ordinary QString, and each string stored is a view of part of a buffer made with
+	// QString::fromRawData(): reading it reads the buffer, and editing it first copies it into memory of its own, as Qt
+	// does for any such string, so only the values that are edited get memory of their own.
+	// The views do not keep their buffers alive, so whoever keeps the strings must keep the buffers for as long
+	// (see take_buffers()), and give the strings memory of their own with own() before handing them to anyone else.
+	class StringArena {
+		private:
+		// The size of each buffer in UTF-16 code units.
+		static constexpr qsizetype bufferSize = 8 * 1024;
+		// Strings at least this long in UTF-8 bytes are allocated on their own rather than use up most of a buffer.
+		static constexpr qsizetype maxStoredSize = bufferSize / 8;
+
+		// The buffers filled so far; strings are being stored in the last one.
+		std::vector<QString> buffers;
+		// The number of code units of the last buffer used so far.
+		qsizetype used;
+
+		public:
+		StringArena(): buffers(), used(bufferSize) {}
+
+		StringArena(StringArena const &) = delete;
+		StringArena &operator=(StringArena const &) = delete;
+
+		// Returns a string with the given UTF-8 bytes, converted like QString::fromUtf8() into the current buffer.
+		QString store(QByteArrayView const utf8) {
+			if(utf8.isEmpty()) {
+				return QString();
+			}
+			if(utf8.size() >= maxStoredSize) {
+				return QString::fromUtf8(utf8);
+			}
+
+			// UTF-16 never takes more code units than UTF-8 takes bytes.
+			if(bufferSize - used < utf8.size()) {
+				buffers.emplace_back(bufferSize, Qt::Uninitialized);
+				used = 0;
+			}
+
+			// Only this arena has the buffer, so writing to it does not copy it.
+			QChar *const begin = buffers.back().data() + used;
+			QStringDecoder decoder(
+					QStringDecoder::Utf8, QStringDecoder::Flag::Stateless | QStringDecoder::Flag::ConvertInitialBom);
+			QChar *const end = decoder.appendToBuffer(begin, utf8);
+			qsizetype const size = end - begin;
+			used += size;
+
+			return QString::fromRawData(begin, size);
+		}
+
+		// Returns the buffers that the strings stored so far lie in, leaving this arena empty.
+		std::vector<QString> take_buffers() noexcept {
+			used = bufferSize;
+			return std::exchange(buffers, {});
+		}
+	};
+} // namespace omm
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QByteArray>
+#include <QTest>
+#include <QtDebug>
+#include <array>
+#include <cstddef>
+
+#include "allocations.hpp"
+
+#if defined(Q_OS_WIN)
+// Keep windows.h from defining min() and max() as macros.
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Exclusive namespace for the OMM.
+namespace omm {
+	// The numbers of entries of the synthetic libraries that the benchmarks run on.
+	inline constexpr std::array<int, 4> benchmarkSizes{1000, 10000, 100000, 1000000};
+
+	// Returns the name of the row of a benchmark for the given number of entries (e.g. "10k" or "1M").
+	inline QByteArray size_name(int const count) {
+		if(count >= 1000000) {
+			return QByteArray::number(count / 1000000) + 'M';
+		}
+		if(count >= 1000) {
+			return QByteArray::number(count / 1000) + 'k';
+		}
+		return QByteArray::number(count);
+	}
+
+	// Add a column with the number of entries to the data of a benchmark, and a row for each of benchmarkSizes.
+	inline void add_size_rows() {
+		QTest::addColumn<int>("entries");
+		for(int const count: benchmarkSizes) {
+			QTest::newRow(size_name(count).constData()) << count;
+		}
+	}
+
+	// Measure the given function with QBENCHMARK, and report how many allocations each run made on average
+	// (see get_allocations()), along with the time that QtTest reports.
+	template<typename Run>
+	void measure(Run &&run) {
+		Allocations const before = get_allocations();
+		std::size_t runs = 0;
+		QBENCHMARK {
+			run();
+			++runs;
+		}
+		Allocations const after = get_allocations();
+		if(runs) {
+			qInfo().noquote() << QString::number((after.count - before.count) / runs) << u"allocations,"_qs
+							  << QString::number(static_cast<double>(after.bytes - before.bytes) / runs / (1 << 20), 'f', 1)
+							  << u"MiB per run"_qs;
+		}
+	}
+
+	// Returns the most memory that the process has had resident so far in bytes, or 0 if it is not known.
+	inline std::size_t peak_memory() {
+#if defined(Q_OS_WIN)
+		PROCESS_MEMORY_COUNTERS counters{};
+		return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+		rusage usage{};
+		if(getrusage(RUSAGE_SELF, &usage) != 0) {
+			return 0;
+		}
+#if defined(Q_OS_MACOS)
+		return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+		// Linux reports it in KiB.
+		return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+	}
+} // namespace omm
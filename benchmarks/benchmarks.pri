@@ -0,0 +1,20 @@
+# The settings shared by the benchmarks: QtTest without the GUI, and the allocations of each run counted, down to
+# those made with malloc where glibc allows it (see allocations.cpp).
+QT += testlib
+QT -= gui
+
+CONFIG += c++17 console benchmark
+CONFIG -= app_bundle
+
+DEFINES += OMM_COUNT_ALLOCATIONS OMM_COUNT_MALLOC
+INCLUDEPATH += $$PWD $$PWD/../OMM
+
+SOURCES += \
+	$$PWD/../OMM/allocations.cpp
+
+HEADERS += \
+	$$PWD/../OMM/allocations.hpp \
+	$$PWD/benchmark.hpp
+
+# The benchmarks read the peak memory of the process.
+win32: LIBS += -lpsapi
@@ -0,0 +1,6 @@
+# The benchmarks of the hot paths of the OMM, one QtTest executable each; run them with make benchmark.
+TEMPLATE = subdirs
+
+SUBDIRS += \
+	chapter \
+	library
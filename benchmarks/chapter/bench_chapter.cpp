@@ -0,0 +1,132 @@
+#include <QString>
+#include <QTest>
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "chapter.hpp"
+
+using omm::Chapter;
+
+// The benchmark of parsing chapters in string form, against the parser that Chapter used before it parsed in place.
+class BenchChapter: public QObject {
+	Q_OBJECT
+
+	private:
+	// The number of chapters parsed by each run.
+	static constexpr std::size_t corpusSize = 1000000;
+
+	// The chapters parsed by each run, the same every time.
+	std::vector<QString> corpus;
+	// Keeps the results of the runs from being optimized away.
+	std::size_t volatile sink;
+
+	// Returns the left end of the given chapter as parsed before chapters were parsed in place: converted to a
+	// std::string, read with std::stoi and std::atoi inside a try block, and kept in a std::vector.
+	static std::vector<int> parse_old(QString const &chapter) {
+		std::vector<int> l, r;
+		std::string const cs(chapter.toStdString());
+		auto ri = cs.find('~'), npos = std::string::npos;
+		try {
+			l.push_back(std::stoi(cs));
+			for(auto si = cs.find('.'); si != npos && si < ri; si = cs.find('.', si + 1)) {
+				l.push_back(std::atoi(cs.data() + si + 1));
+			}
+			if(ri == npos) {
+				r = l;
+			}
+			else {
+				r.push_back(std::stoi(cs.data() + ri + 1));
+				for(auto si = cs.find('.', ri + 1); si != npos; si = cs.find('.', si + 1)) {
+					r.push_back(std::atoi(cs.data() + si + 1));
+				}
+			}
+		}
+		catch(std::exception const &) {
+			l.clear(), r.clear();
+		}
+
+		// Only a range limited to its last component is kept, with a reversed range swapped around.
+		if(l.empty() || l.size() != r.size() || !std::equal(l.begin(), l.end() - 1, r.begin())) {
+			l.clear(), r.clear();
+		}
+		else if(l.back() > r.back()) {
+			l.swap(r);
+		}
+		return l;
+	}
+
+	public:
+	BenchChapter(): corpus(), sink(0) {}
+
+	private slots:
+	// Make the corpus: mostly single chapters, then deeper chapters and ranges, and a few that are not chapters.
+	void initTestCase() {
+		std::mt19937 random(1);
+		auto const number = [&](int const max) {
+			return QString::number(std::uniform_int_distribution<int>(1, max)(random));
+		};
+		corpus.reserve(corpusSize);
+		for(std::size_t a = 0; a < corpusSize; ++a) {
+			switch(std::uniform_int_distribution<int>(0, 19)(random)) {
+				case 0:
+					corpus.push_back(u"Chapter "_qs + number(500));
+					break;
+				case 1:
+				case 2:
+					corpus.push_back(number(500) + u'~' + number(500));
+					break;
+				case 3:
+					corpus.push_back(number(20) + u'.' + number(50) + u'~' + number(50));
+					break;
+				case 4:
+				case 5:
+				case 6:
+					corpus.push_back(number(20) + u'.' + number(50));
+					break;
+				case 7:
+					corpus.push_back(number(20) + u'.' + number(50) + u'.' + number(9));
+					break;
+				default:
+					corpus.push_back(number(500));
+					break;
+			}
+		}
+	}
+
+	// Both parsers read every chapter of the corpus the same way.
+	void parsers_agree() {
+		for(auto const &a: corpus) {
+			Chapter const chapter(a);
+			std::vector<int> const old = parse_old(a);
+			QVERIFY2(std::equal(chapter.get_l().begin(), chapter.get_l().end(), old.begin(), old.end()), qPrintable(a));
+		}
+	}
+
+	void parse() {
+		QBENCHMARK {
+			std::size_t depth = 0;
+			for(auto const &a: corpus) {
+				depth += Chapter(a).get_l().size();
+			}
+			sink = depth;
+		}
+	}
+
+	void parse_old_parser() {
+		QBENCHMARK {
+			std::size_t depth = 0;
+			for(auto const &a: corpus) {
+				depth += parse_old(a).size();
+			}
+			sink = depth;
+		}
+	}
+};
+
+QTEST_APPLESS_MAIN(BenchChapter)
+
+#include "bench_chapter.moc"
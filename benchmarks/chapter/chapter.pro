@@ -0,0 +1,11 @@
+include(../benchmarks.pri)
+
+TARGET = bench_chapter
+
+SOURCES += \
+	../../OMM/chapter.cpp \
+	bench_chapter.cpp
+
+HEADERS += \
+	../../OMM/chapter.hpp \
+	../../OMM/components.hpp
@@ -0,0 +1,446 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTextStream>
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "chapters.hpp"
+#include "entries.hpp"
+#include "generator.hpp"
+#include "save.hpp"
+
+using omm::Chapters;
+using omm::Entries;
+using omm::Entry;
+using omm::EntryVector;
+using omm::Field;
+using omm::Generator;
+using omm::Save;
+
+// The benchmarks of the hot paths of the OMM on synthetic libraries of each of omm::benchmarkSizes entries, made by
+// omm::Generator from the same seed every time. Each run builds its result from scratch and frees it afterwards.
+class BenchLibrary: public QObject {
+	Q_OBJECT
+
+	private:
+	// The directory of the saves of the libraries, removed along with them at the end.
+	QTemporaryDir directory;
+	// The number of entries of the library generated last.
+	int generatedSize;
+	// The library generated last, as generated (not sorted yet); kept for the benchmarks that run on the same size.
+	std::optional<Entries> generated;
+	// The JSON saves of the libraries written so far, by their number of entries.
+	std::map<int, QString> jsonPaths;
+	// The binary saves of the libraries written so far, by their number of entries.
+	std::map<int, QString> binaryPaths;
+	// Keeps the results of the runs from being optimized away.
+	std::size_t volatile sink;
+
+	// Returns the library of the given number of entries, as generated.
+	Entries const &library(int const count) {
+		if(!generated || generatedSize != count) {
+			generated.reset();
+			generated.emplace();
+			Generator(1).generate(*generated, static_cast<std::size_t>(count));
+			generatedSize = count;
+		}
+		return *generated;
+	}
+
+	// Returns the path of the JSON save of the library of the given number of entries, writing it the first time.
+	QString const &json_path(int const count) {
+		auto pi = jsonPaths.find(count);
+		if(pi == jsonPaths.end()) {
+			QString const path = directory.filePath(u"omm-%1.json"_qs.arg(count));
+			if(!Generator::write(path, library(count))) {
+				qFatal("Could not write the synthetic library.");
+			}
+			pi = jsonPaths.emplace(count, path).first;
+		}
+		return pi->second;
+	}
+
+	// Returns the path of the binary save of the library of the given number of entries, writing it the first time.
+	QString const &binary_path(int const count) {
+		auto pi = binaryPaths.find(count);
+		if(pi == binaryPaths.end()) {
+			QString const path = directory.filePath(u"omm-%1.bin"_qs.arg(count));
+			if(!Save::json_to_binary(json_path(count), path)) {
+				qFatal("Could not write the synthetic library in the binary save format.");
+			}
+			pi = binaryPaths.emplace(count, path).first;
+		}
+		return pi->second;
+	}
+
+	// Returns true if the given entry comes before the other by title, type, author, and year,
+	// running the collator on the fields that differ.
+	static bool less_uncached(Entry const &l, Entry const &r) {
+		for(Field const field: {Field::Title, Field::Type, Field::Author, Field::Year}) {
+			if(l.at(field) != r.at(field)) {
+				return l.less(l.at(field), r.at(field));
+			}
+		}
+		return false;
+	}
+
+	// Sort the given entries the way Entries::sort() did before the sort keys were cached, running the collator on
+	// every comparison, and organize their chapters; returns the number of entries.
+	// Only the order of pointers to the entries is sorted, which leaves out moving the entries themselves.
+	static std::size_t sort_uncached(Entries &entries) {
+		std::vector<Entry const *> sorted;
+		for(auto const &entry: std::as_const(entries)) {
+			sorted.push_back(&entry);
+		}
+
+		auto const fskey = Field::FranchiseSeries, fsokey = Field::FranchiseSeriesOrder;
+		auto partIter = std::partition(sorted.begin(), sorted.end(), [&](Entry const *const entry) {
+			return !entry->at(fskey).isEmpty();
+		});
+		std::sort(sorted.begin(), partIter, [&](Entry const *const l, Entry const *const r) {
+			if(l->at(fskey) != r->at(fskey)) {
+				return l->less(l->at(fskey), r->at(fskey));
+			}
+			if(l->at(fsokey) != r->at(fsokey)) {
+				return l->at(fsokey).toInt() < r->at(fsokey).toInt();
+			}
+			return less_uncached(*l, *r);
+		});
+		std::sort(partIter, sorted.end(), [](Entry const *const l, Entry const *const r) {
+			return less_uncached(*l, *r);
+		});
+
+		for(EntryVector::size_type a = 0; a < entries.size(); ++a) {
+			entries.edit_entry(a, [](Entry &entry) {
+				entry.organize_chapters();
+			});
+		}
+		return sorted.size();
+	}
+
+	// Load the save at the given path into the given save in the given way of loadWays:
+	// - "stream": Save::load(), which streams the file into the entries;
+	// - "document": reading the file whole and parsing it into a QJsonDocument for Save::from_json(), as the OMM
+	//   loaded saves before it streamed them;
+	// - "binary": Save::load_binary(), accessing every entry as well to decode it, since the file is only mapped.
+	// Returns false if the save could not be loaded.
+	static bool load_in(Save &save, QString const &way, QString const &path) {
+		if(way == u"document"_qs) {
+			QFile file(path);
+			if(!file.open(QIODevice::ReadOnly)) {
+				return false;
+			}
+			QJsonParseError error;
+			QJsonDocument const document = QJsonDocument::fromJson(file.readAll(), &error);
+			if(error.error != QJsonParseError::NoError) {
+				return false;
+			}
+			save.from_json(document.object());
+			return true;
+		}
+		if(way == u"binary"_qs) {
+			if(!save.load_binary(path)) {
+				return false;
+			}
+			for(EntryVector::size_type a = 0; a < save.size(); ++a) {
+				save.get_entry(a);
+			}
+			return true;
+		}
+		return save.load(path);
+	}
+
+	// Load the save of the library of the given number of entries into the given save.
+	void load(Save &save, int const count) {
+		if(!save.load(json_path(count))) {
+			qFatal("Could not load the synthetic library.");
+		}
+	}
+
+	public:
+	// The option that runs the executable as the process that load_peak_memory() measures, followed by the way to
+	// load the save and its path.
+	static constexpr char const *peakMemoryOption = "--peak-memory";
+	// The ways that load_in() loads a save.
+	static inline QStringList const loadWays{u"stream"_qs, u"document"_qs, u"binary"_qs};
+
+	// Load the save at the given path in the given way of loadWays, and write the peak memory of the process before
+	// and after loading it to the standard output; returns the exit code of the process.
+	static int measure_peak_memory(QString const &way, QString const &path) {
+		std::size_t const before = omm::peak_memory();
+		Save save;
+		if(!load_in(save, way, path)) {
+			return 1;
+		}
+		QTextStream(stdout) << before << ' ' << omm::peak_memory() << Qt::endl;
+		return 0;
+	}
+
+	BenchLibrary(): directory(), generatedSize(0), generated(), jsonPaths(), binaryPaths(), sink(0) {}
+
+	private slots:
+	void initTestCase() {
+		QVERIFY(directory.isValid());
+	}
+
+	// Parsing and organizing the reading histories of the whole library.
+	void organize_data() {
+		omm::add_size_rows();
+	}
+
+	void organize() {
+		QFETCH(int, entries);
+		std::vector<QStringList> histories;
+		for(auto const &entry: library(entries)) {
+			QStringList history;
+			entry.get_likedChapters().for_each_string([&](QString const &chapter) {
+				history.append(chapter);
+			});
+			histories.push_back(std::move(history));
+		}
+
+		omm::measure([&] {
+			std::size_t size = 0;
+			for(auto const &a: histories) {
+				Chapters list(u"Liked Chapters"_qs);
+				list.add(a);
+				size += list.size();
+			}
+			sink = size;
+		});
+	}
+
+	// Sorting a copy of the library as generated, which computes the sort keys of every entry: with the cached sort
+	// keys on one thread and on every thread, and with the collator run on every comparison, as before the sort keys
+	// were cached.
+	void sort_data() {
+		QTest::addColumn<int>("entries");
+		QTest::addColumn<int>("threads");
+		QTest::addColumn<bool>("cached");
+		for(int const count: {10000, 100000, 1000000}) {
+			QByteArray const size = omm::size_name(count);
+			QTest::newRow((size + " uncached").constData()) << count << 1 << false;
+			QTest::newRow((size + " cached").constData()) << count << 1 << true;
+			QTest::newRow((size + " cached, every thread").constData()) << count << 0 << true;
+		}
+	}
+
+	void sort() {
+		QFETCH(int, entries);
+		QFETCH(int, threads);
+		QFETCH(bool, cached);
+		Entries const &unsorted = library(entries);
+		omm::measure([&] {
+			Entries copy(unsorted);
+			copy.set_thread_count(static_cast<unsigned>(threads));
+			sink = cached ? copy.sort().size() : sort_uncached(copy);
+		});
+	}
+
+	// Recounting the entries of the library.
+	void re_count_data() {
+		omm::add_size_rows();
+	}
+
+	void re_count() {
+		QFETCH(int, entries);
+		Save save;
+		load(save, entries);
+		omm::measure([&] {
+			save.re_count();
+		});
+	}
+
+	// Converting the library to a JSON document.
+	void to_json_data() {
+		omm::add_size_rows();
+	}
+
+	void to_json() {
+		QFETCH(int, entries);
+		Save save;
+		load(save, entries);
+		omm::measure([&] {
+			QJsonObject json;
+			save.to_json(json);
+			sink = static_cast<std::size_t>(json.size());
+		});
+	}
+
+	// Converting the library from a JSON document.
+	void from_json_data() {
+		omm::add_size_rows();
+	}
+
+	void from_json() {
+		QFETCH(int, entries);
+		QJsonObject json;
+		{
+			Save save;
+			load(save, entries);
+			save.to_json(json);
+		}
+		omm::measure([&] {
+			Save save;
+			save.from_json(json);
+			sink = save.size();
+		});
+	}
+
+	// Loading the library in each of the ways that load_in() knows.
+	void load_data() {
+		QTest::addColumn<int>("entries");
+		QTest::addColumn<QString>("way");
+		for(int const count: omm::benchmarkSizes) {
+			for(QString const &way: loadWays) {
+				QTest::newRow((omm::size_name(count) + ' ' + way.toUtf8()).constData()) << count << way;
+			}
+		}
+	}
+
+	void load() {
+		QFETCH(int, entries);
+		QFETCH(QString, way);
+		QString const &path = way == u"binary"_qs ? binary_path(entries) : json_path(entries);
+		omm::measure([&] {
+			Save save;
+			QVERIFY(load_in(save, way, path));
+			sink = save.size();
+		});
+	}
+
+	// The peak memory of loading the library in each of the ways that load_in() knows, measured in a process of its
+	// own (see measure_peak_memory()), so that the memory taken by the benchmarks before does not hide it.
+	void load_peak_memory_data() {
+		load_data();
+	}
+
+	void load_peak_memory() {
+		QFETCH(int, entries);
+		QFETCH(QString, way);
+		QString const &path = way == u"binary"_qs ? binary_path(entries) : json_path(entries);
+		QProcess process;
+		process.start(QCoreApplication::applicationFilePath(), {QString::fromLatin1(peakMemoryOption), way, path});
+		QVERIFY(process.waitForFinished(-1));
+		QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+		QCOMPARE(process.exitCode(), 0);
+		QList<QByteArray> const peaks = process.readAllStandardOutput().trimmed().split(' ');
+		QCOMPARE(peaks.size(), 2);
+		qint64 const before = peaks[0].toLongLong(), after = peaks[1].toLongLong();
+		qInfo().noquote() << QString::number(static_cast<double>(after) / (1 << 20), 'f', 1)
+						  << u"MiB peak resident memory, up"_qs
+						  << QString::number(static_cast<double>(after - before) / (1 << 20), 'f', 1)
+						  << u"MiB from before loading"_qs;
+		QTest::setBenchmarkResult(static_cast<qreal>(after - before), QTest::BytesAllocated);
+	}
+
+	// Saving the library to a JSON save.
+	void save_data() {
+		omm::add_size_rows();
+	}
+
+	void save() {
+		QFETCH(int, entries);
+		Save save;
+		load(save, entries);
+		QString const path = directory.filePath(u"omm-save.json"_qs);
+		omm::measure([&] {
+			QVERIFY(save.save(path));
+		});
+		QFile::remove(path);
+	}
+
+	// Saving the library to a binary save.
+	void save_binary_data() {
+		omm::add_size_rows();
+	}
+
+	void save_binary() {
+		QFETCH(int, entries);
+		Save save;
+		load(save, entries);
+		QString const path = directory.filePath(u"omm-save.bin"_qs);
+		omm::measure([&] {
+			QVERIFY(save.save_binary(path));
+		});
+		QFile::remove(path);
+	}
+
+	// Copying the save to save it on another thread, which copies every entry but shares its field values.
+	void copy_data() {
+		omm::add_size_rows();
+	}
+
+	void copy() {
+		QFETCH(int, entries);
+		Save save;
+		load(save, entries);
+		omm::measure([&] {
+			Save copy(save);
+			sink = copy.size();
+		});
+	}
+
+	// Building the full-text index on the first search of a fresh copy of the save.
+	void search_index_data() {
+		omm::add_size_rows();
+	}
+
+	void search_index() {
+		QFETCH(int, entries);
+		Save save;
+		load(save, entries);
+		omm::measure([&] {
+			Save copy(save);
+			sink = copy.search(u"the"_qs).size();
+		});
+	}
+
+	// Searching for the first word of the title of every hundredth entry once the full-text index is built.
+	void search_data() {
+		omm::add_size_rows();
+	}
+
+	void search() {
+		QFETCH(int, entries);
+		Save save;
+		load(save, entries);
+		QStringList queries;
+		for(EntryVector::size_type a = 0; a < save.size(); a += 100) {
+			queries.append(save.get_entry(a).at(Field::Title).section(u' ', 0, 0));
+		}
+		sink = save.search(queries.value(0)).size();
+		omm::measure([&] {
+			std::size_t found = 0;
+			for(auto const &a: std::as_const(queries)) {
+				found += save.search(a).size();
+			}
+			sink = found;
+		});
+	}
+};
+
+int main(int argc, char *argv[]) {
+	QCoreApplication app(argc, argv);
+	if(argc == 4 && qstrcmp(argv[1], BenchLibrary::peakMemoryOption) == 0) {
+		return BenchLibrary::measure_peak_memory(QString::fromLocal8Bit(argv[2]), QString::fromLocal8Bit(argv[3]));
+	}
+
+	BenchLibrary bench;
+	return QTest::qExec(&bench, argc, argv);
+}
+
+#include "bench_library.moc"
@@ -0,0 +1,10 @@
+include(../benchmarks.pri)
+include(../../OMM/core.pri)
+
+TARGET = bench_library
+
+SOURCES += \
+	bench_library.cpp
+
+HEADERS += \
+	../../OMM/generator.hpp
@@ -0,0 +1,6 @@
+include(../tests.pri)
+
+TARGET = test_chapters
+
+SOURCES += \
+	test_chapters.cpp
@@ -0,0 +1,79 @@
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QTest>
+
+#include "chapters.hpp"
+
+using omm::Chapters;
+
+// The tests of adding and removing chapters in a list of chapters.
+class TestChapters: public QObject {
+	Q_OBJECT
+
+	private:
+	// Returns the chapters in the given list in string form, in order.
+	static QStringList strings(Chapters const &chapters) {
+		QStringList list;
+		chapters.for_each_string([&](QString const &chapter) {
+			list.append(chapter);
+		});
+		return list;
+	}
+
+	// Returns a list with the given chapters added in string form.
+	static Chapters with(QStringList const &added) {
+		Chapters chapters(u"Chapters"_qs);
+		for(auto const &a: added) {
+			chapters.add(QStringView(a));
+		}
+		return chapters;
+	}
+
+	private slots:
+	void remove_data() {
+		QTest::addColumn<QStringList>("added");
+		QTest::addColumn<QString>("removed");
+		QTest::addColumn<QStringList>("expected");
+
+		QTest::newRow("middle of a range") << QStringList{u"1~10"_qs} << u"3~5"_qs
+										   << QStringList{u"1 ~ 2"_qs, u"6 ~ 10"_qs};
+		QTest::newRow("end of a range") << QStringList{u"1~10"_qs} << u"10"_qs << QStringList{u"1 ~ 9"_qs};
+		QTest::newRow("across ranges") << QStringList{u"1~3"_qs, u"5~8"_qs} << u"2~6"_qs
+									   << QStringList{u"1"_qs, u"7 ~ 8"_qs};
+		QTest::newRow("deeper chapters within") << QStringList{u"1~10"_qs, u"3.1"_qs, u"4.5~4.7"_qs} << u"3~5"_qs
+												<< QStringList{u"1 ~ 2"_qs, u"6 ~ 10"_qs};
+		QTest::newRow("split keeps deeper chapters")
+				<< QStringList{u"1~10"_qs, u"2.5"_qs, u"5.2"_qs, u"9.1"_qs} << u"3~5"_qs
+				<< QStringList{u"1 ~ 2"_qs, u"2.5"_qs, u"5.2"_qs, u"6 ~ 10"_qs, u"9.1"_qs};
+		QTest::newRow("single chapter keeps deeper chapters")
+				<< QStringList{u"1~10"_qs, u"5.2"_qs} << u"5"_qs
+				<< QStringList{u"1 ~ 4"_qs, u"5.2"_qs, u"6 ~ 10"_qs};
+		QTest::newRow("deeper chapter") << QStringList{u"3.1~3.9"_qs} << u"3.4~3.5"_qs
+										<< QStringList{u"3.1 ~ 3.3"_qs, u"3.6 ~ 3.9"_qs};
+	}
+
+	void remove() {
+		QFETCH(QStringList, added);
+		QFETCH(QString, removed);
+		QFETCH(QStringList, expected);
+
+		Chapters chapters = with(added);
+		chapters.remove(QStringView(removed));
+		QCOMPARE(strings(chapters), expected);
+	}
+
+	// Removing a range from a list that was loaded and never parsed gives the same result as from one built by adding.
+	void remove_loaded() {
+		QJsonObject json{{u"Chapters"_qs, QJsonArray{u"1~10"_qs, u"5.2"_qs}}};
+		Chapters chapters(u"Chapters"_qs);
+		chapters.from_json(json);
+		chapters.remove(QStringView(u"3~5"));
+		QCOMPARE(strings(chapters), (QStringList{u"1 ~ 2"_qs, u"5.2"_qs, u"6 ~ 10"_qs}));
+	}
+};
+
+QTEST_APPLESS_MAIN(TestChapters)
+
+#include "test_chapters.moc"
@@ -0,0 +1,6 @@
+include(../tests.pri)
+
+TARGET = test_entries
+
+SOURCES += \
+	test_entries.cpp
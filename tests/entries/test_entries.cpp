@@ -0,0 +1,96 @@
+#include <QBuffer>
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QTest>
+
+#include "entries.hpp"
+#include "jsonreader.hpp"
+#include "jsonwriter.hpp"
+
+using omm::Entries;
+using omm::Field;
+
+// The tests of saving and loading the stable IDs of a list of entries.
+class TestEntries: public QObject {
+	Q_OBJECT
+
+	private:
+	// Returns a list of two entries saved with the IDs 7 and 3, the first with a custom field named like the
+	// member that holds the IDs of an entry in other formats.
+	static QJsonObject saved() {
+		return QJsonObject{{u"Entries"_qs, QJsonArray{QJsonObject{{u"Title"_qs, u"Monster"_qs}, {u"_ID"_qs, u"M-1"_qs}},
+				QJsonObject{{u"Title"_qs, u"Pluto"_qs}}}},
+				{Entries::get_ids_name(), QJsonArray{7, 3}}};
+	}
+
+	// Check that the given list matches the one saved by saved().
+	static void verify(Entries const &entries) {
+		QCOMPARE(entries.size(), std::size_t(2));
+		QCOMPARE(entries.get_id(0), omm::EntryId(7));
+		QCOMPARE(entries.get_id(1), omm::EntryId(3));
+		QCOMPARE(entries.find_id(3), std::size_t(1));
+		QCOMPARE(entries[0].at(Field::Title), u"Monster"_qs);
+		QCOMPARE(entries[0].at(u"_ID"_qs), u"M-1"_qs);
+		QCOMPARE(entries[1].at(Field::Title), u"Pluto"_qs);
+	}
+
+	private slots:
+	// The IDs are kept apart from the fields in JSON, so a custom field may have any name.
+	void json() {
+		Entries entries;
+		entries.from_json(saved());
+		verify(entries);
+
+		QJsonObject json;
+		entries.to_json(json);
+		QJsonArray const ids = json[Entries::get_ids_name()].toArray();
+		QCOMPARE(ids.size(), qsizetype(2));
+		QCOMPARE(ids.at(0).toInteger(), qint64(7));
+		QCOMPARE(ids.at(1).toInteger(), qint64(3));
+		QCOMPARE(json[u"Entries"_qs].toArray().at(0).toObject()[u"_ID"_qs].toString(), u"M-1"_qs);
+	}
+
+	// Streaming the entries out and back in keeps the IDs and every field.
+	void writer_reader() {
+		Entries entries;
+		entries.from_json(saved());
+
+		QByteArray data;
+		QBuffer device(&data);
+		QVERIFY(device.open(QIODevice::WriteOnly));
+		{
+			omm::JsonWriter writer(device);
+			writer.begin_object();
+			entries.to_writer(writer);
+			entries.ids_to_writer(writer);
+			writer.end_object();
+			QVERIFY(writer.flush());
+		}
+		device.close();
+
+		QVERIFY(device.open(QIODevice::ReadOnly));
+		omm::JsonReader reader(device);
+		Entries loaded;
+		QVERIFY(reader.enter_object());
+		QString key;
+		while(reader.next_key(key)) {
+			if(key == loaded.get_name()) {
+				QVERIFY(loaded.from_reader(reader));
+			}
+			else if(key == Entries::get_ids_name()) {
+				QVERIFY(loaded.ids_from_reader(reader));
+			}
+			else {
+				reader.skip_value();
+			}
+		}
+		QVERIFY(!reader.has_error());
+		verify(loaded);
+	}
+};
+
+QTEST_APPLESS_MAIN(TestEntries)
+
+#include "test_entries.moc"
@@ -0,0 +1,6 @@
+include(../tests.pri)
+
+TARGET = test_stringarena
+
+SOURCES += \
+	test_stringarena.cpp
@@ -0,0 +1,117 @@
+#include <QBuffer>
+#include <QByteArray>
+#include <QString>
+#include <QTest>
+
+#include "entries.hpp"
+#include "jsonreader.hpp"
+#include "stringarena.hpp"
+
+using omm::Entries;
+using omm::Field;
+using omm::StringArena;
+
+// The tests of storing strings in the buffers of a StringArena and of the entries loaded into them.
+class TestStringArena: public QObject {
+	Q_OBJECT
+
+	private slots:
+	void store_data() {
+		QTest::addColumn<QByteArray>("utf8");
+
+		QTest::newRow("ASCII") << QByteArray("Title");
+		QTest::newRow("non-ASCII") << QByteArray("Tōkyō Ghoul");
+		QTest::newRow("surrogate pair") << QByteArray("\xF0\x9F\x93\x9A Books");
+		QTest::newRow("long") << QByteArray(4096, 'a');
+	}
+
+	// A stored string has the same value as the string decoded from the same bytes on its own.
+	void store() {
+		QFETCH(QByteArray, utf8);
+
+		StringArena arena;
+		QCOMPARE(arena.store(utf8), QString::fromUtf8(utf8));
+	}
+
+	// An empty string takes no space in the buffers.
+	void store_empty() {
+		StringArena arena;
+		QString const stored = arena.store(QByteArrayView());
+		QVERIFY(stored.isEmpty());
+		QVERIFY(!omm::is_view(stored));
+		QVERIFY(arena.take_buffers().empty());
+	}
+
+	// Short strings are views that follow each other in one buffer, while long ones have memory of their own.
+	void store_views() {
+		StringArena arena;
+		QString const first = arena.store("first");
+		QString const second = arena.store("second");
+		QString const long_ = arena.store(QByteArray(4096, 'a'));
+		QVERIFY(omm::is_view(first));
+		QVERIFY(omm::is_view(second));
+		QVERIFY(!omm::is_view(long_));
+		QCOMPARE(second.constData(), first.constData() + first.size());
+		QCOMPARE(arena.take_buffers().size(), std::size_t(1));
+	}
+
+	// Editing a stored string copies it, leaving the buffer and the other strings in it as they were.
+	void edit_copies() {
+		StringArena arena;
+		QString first = arena.store("first");
+		QString const second = arena.store("second");
+		QChar const *const buffer = second.constData() - first.size();
+		first.append(u"!"_qs);
+		QVERIFY(!omm::is_view(first));
+		QCOMPARE(first, u"first!"_qs);
+		QCOMPARE(second, u"second"_qs);
+		QCOMPARE(QStringView(buffer, 5), QStringView(u"first"));
+	}
+
+	// Owning a view copies it, and owning any other string leaves it as it is.
+	void own() {
+		StringArena arena;
+		QString view = arena.store("view");
+		QChar const *const stored = view.constData();
+		omm::own(view);
+		QVERIFY(!omm::is_view(view));
+		QVERIFY(view.constData() != stored);
+		QCOMPARE(view, u"view"_qs);
+
+		QString owned = u"owned"_qs;
+		QChar const *const data = owned.constData();
+		omm::own(owned);
+		QCOMPARE(owned.constData(), data);
+	}
+
+	// Entries loaded into an arena keep its buffers, and an entry added to another list outlives the list it came
+	// from.
+	void entries_outlive_source() {
+		QByteArray json(R"([{"Title": "Monster", "Author": "Urasawa", "Liked Chapters": ["1~10", "5.2"]},
+				{"Title": "Pluto", "Author": "Urasawa"}])");
+		QBuffer device(&json);
+		QVERIFY(device.open(QIODevice::ReadOnly));
+
+		Entries copied;
+		{
+			Entries loaded;
+			omm::JsonReader reader(device);
+			QVERIFY(loaded.from_reader(reader));
+			QCOMPARE(loaded.size(), std::size_t(2));
+			QVERIFY(omm::is_view(loaded[0].at(Field::Title)));
+			for(std::size_t a = 0; a < loaded.size(); ++a) {
+				copied.add_entry(omm::Entry(loaded[a]));
+			}
+		}
+
+		QCOMPARE(copied.size(), std::size_t(2));
+		QVERIFY(!omm::is_view(copied[0].at(Field::Title)));
+		QCOMPARE(copied[0].at(Field::Title), u"Monster"_qs);
+		QCOMPARE(copied[0].at(Field::Author), u"Urasawa"_qs);
+		QCOMPARE(copied[1].at(Field::Title), u"Pluto"_qs);
+	}
+};
+
+QTEST_APPLESS_MAIN(TestStringArena)
+
+#include "test_stringarena.moc"
@@ -0,0 +1,10 @@
+# The settings shared by the tests: QtTest without the GUI, built on the core of the OMM.
+QT += testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD
+
+include($$PWD/../OMM/core.pri)
@@ -0,0 +1,7 @@
+# The tests of the core of the OMM, one QtTest executable each; run them with make check.
+TEMPLATE = subdirs
+
+SUBDIRS += \
+	chapters \
+	entries \
+	stringarena